@@ -0,0 +1,111 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+namespace DriverSDK
+{
+    Arena::Arena()
+    {
+        base = nullptr;
+        capacity = 0;
+        used.store(0);
+        hugepage = false;
+    }
+
+    Arena &Arena::instance()
+    {
+        static Arena arena;
+        return arena;
+    }
+
+    // 映射内存区，只允许初始化一次；区域在进程退出前不会解除映射，
+    // 这样静态对象析构时释放的指针仍然有效
+    int Arena::init(size_t const capacity)
+    {
+        if (base != nullptr)
+        {
+            return 0;
+        }
+        size_t size = (capacity + ARENA_SIZE - 1) / ARENA_SIZE * ARENA_SIZE;
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_HUGETLB, -1, 0);
+        hugepage = ptr != MAP_FAILED;
+        if (ptr == MAP_FAILED)
+        {
+            ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        }
+        if (ptr == MAP_FAILED)
+        {
+            printf("arena mmap failed, falling back to heap allocation\n");
+            return -1;
+        }
+        if (mlock(ptr, size) != 0)
+        {
+            printf("arena mlock failed\n");
+        }
+        memset(ptr, 0, size);
+        this->capacity = size;
+        used.store(0);
+        base = (unsigned char *)ptr;
+        printf("arena of %lu bytes mapped%s\n", size, hugepage ? " on hugepages" : "");
+        return 0;
+    }
+
+    // 分配按缓存行对齐且长度补齐到整数个缓存行的清零内存，相邻的分配因此不会共享缓存行
+    void *Arena::allocate(size_t const size)
+    {
+        size_t length = (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        if (length == 0)
+        {
+            length = CACHE_LINE_SIZE;
+        }
+        if (base != nullptr)
+        {
+            size_t offset = used.fetch_add(length);
+            if (offset + length <= capacity)
+            {
+                return base + offset;
+            }
+            printf("arena exhausted, %lu bytes allocated from heap\n", length);
+        }
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, CACHE_LINE_SIZE, length) != 0)
+        {
+            return nullptr;
+        }
+        memset(ptr, 0, length);
+        return ptr;
+    }
+
+    // 内存区中的分配随进程一起回收，只有退回到堆上的分配需要释放
+    void Arena::release(void *ptr)
+    {
+        if (ptr != nullptr && !owns(ptr))
+        {
+            free(ptr);
+        }
+    }
+
+    bool Arena::owns(void const *ptr)
+    {
+        return base != nullptr && (unsigned char const *)ptr >= base && (unsigned char const *)ptr < base + capacity;
+    }
+}
@@ -0,0 +1,48 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+
+#define CACHE_LINE_SIZE 64
+#define ARENA_SIZE (2UL << 20)
+
+namespace DriverSDK
+{
+    // SDK内存区：init()时一次性映射一块锁定、预先缺页的内存（优先使用2MB大页），
+    // 之后按缓存行对齐做只增不减的分配；未初始化或用尽时退回到对齐的堆分配
+    class Arena
+    {
+    public:
+        unsigned char *base;
+        size_t capacity;
+        std::atomic<size_t> used;
+        bool hugepage;
+        static Arena &instance();
+        int init(size_t const capacity);
+        void *allocate(size_t const size);
+        void release(void *ptr);
+        bool owns(void const *ptr);
+
+    private:
+        Arena();
+        Arena(Arena const &) = delete;
+        Arena &operator=(Arena const &) = delete;
+    };
+}
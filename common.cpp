@@ -17,24 +17,33 @@
 
 #include "config_xml.h"
 #include "common.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <unistd.h>
+#include <sched.h>
+#include <string.h>
 
 namespace DriverSDK
 {
     extern ConfigXML *configXML;
 
+    cpu_set_t exclusiveCPUs;    // 独占线程占用的CPU
+    std::vector<pthread_t> sharedThreads;    // 已创建的非独占线程
+    std::vector<cpu_set_t> sharedCPUs;    // 非独占线程未扣除独占CPU前的CPU集合
+
     /**
-     * @brief SwapNode构造函数，初始化双向链表节点
+     * @brief SwapNode构造函数，初始化缓冲节点
      * @param size 要分配的内存大小（字节）
      * 
-     * 分配指定大小的内存并清零，初始化前后指针为nullptr
+     * 从SDK内存区分配指定大小、按缓存行对齐的清零内存，提交序号置0
      */
     SwapNode::SwapNode(int const size)
     {
-        memPtr = (unsigned char *)calloc(size, 1);
-        previous = nullptr;
-        next = nullptr;
+        memPtr = (unsigned char *)Arena::instance().allocate(size);
+        sequence = 0;
+        dirty = 0;
+        memset(&frame, 0, sizeof(FrameInfo));
     }
 
     /**
@@ -44,82 +53,743 @@ namespace DriverSDK
      */
     SwapNode::~SwapNode()
     {
-        free(memPtr);
+        Arena::instance().release(memPtr);
+    }
+
+    /**
+     * @brief 从SDK内存区分配SwapNode对象
+     * @param size 对象大小（字节）
+     * @return 按缓存行对齐的内存，写端与读端节点的元数据不会落在同一缓存行
+     */
+    void *SwapNode::operator new(size_t const size)
+    {
+        return Arena::instance().allocate(size);
+    }
+
+    /**
+     * @brief 归还SwapNode对象的内存
+     * @param ptr 对象指针
+     */
+    void SwapNode::operator delete(void *ptr)
+    {
+        Arena::instance().release(ptr);
     }
 
     /**
-     * @brief SwapList构造函数，创建3个节点的循环双向链表
+     * @brief SwapList构造函数，创建单写单读三缓冲
      * @param size 每个节点的内存大小（字节）
      * 
-     * 创建一个包含3个SwapNode的循环双向链表，用于线程安全的内存交换操作
+     * 节点0归写端，节点1为中间节点，节点2归读端；写端只写自己的节点，读端只读自己的节点，
+     * 二者仅通过对middle的原子交换传递节点，因此读端拿到的总是一帧完整提交的数据
      */
     SwapList::SwapList(int const size)
     {
-        nodePtr.store(new SwapNode(size));
-        SwapNode *current = nodePtr.load();
-        int i = 1;
+        this->size = size;
+        int i = 0;
         while (i < 3)
         {
-            SwapNode *node = new SwapNode(size);
-            node->previous = current;
-            current->next = node;
-            current = current->next;
+            nodes[i] = new SwapNode(size);
             i++;
         }
-        nodePtr.load()->previous = current;
-        current->next = nodePtr.load();
+        writeIndex = 0;
+        readIndex = 2;
+        sequence = 0;
+        pending = 0;
+        middle.store(1);
+    }
+
+    /**
+     * @brief 从SDK内存区分配SwapList对象
+     * @param size 对象大小（字节）
+     * @return 按缓存行对齐的内存，保证写端成员、middle与读端成员各占一个缓存行
+     */
+    void *SwapList::operator new(size_t const size)
+    {
+        return Arena::instance().allocate(size);
+    }
+
+    /**
+     * @brief 归还SwapList对象的内存
+     * @param ptr 对象指针
+     */
+    void SwapList::operator delete(void *ptr)
+    {
+        Arena::instance().release(ptr);
+    }
+
+    /**
+     * @brief 添加与域内存交换的区间
+     * @param offset 区间起始偏移（字节）
+     * @param size 区间长度（字节）
+     * 
+     * 区间按偏移升序保存，与已有区间重叠或相邻时合并为一段，减少每周期memcpy的次数
+     */
+    void SwapList::addRange(int const offset, int const size)
+    {
+        if (size <= 0)
+        {
+            return;
+        }
+        auto itr = ranges.begin();
+        while (itr != ranges.end() && itr->offset + itr->size < offset)
+        {
+            itr++;
+        }
+        itr = ranges.insert(itr, SwapRange{offset, size});
+        auto next = itr + 1;
+        while (next != ranges.end() && next->offset <= itr->offset + itr->size)
+        {
+            int end = std::max(itr->offset + itr->size, next->offset + next->size);
+            itr->offset = std::min(itr->offset, next->offset);
+            itr->size = end - itr->offset;
+            next = ranges.erase(next);
+        }
+    }
+
+    /**
+     * @brief 获取偏移所在交换区间对应的脏位
+     * @param offset 数据在节点中的偏移（字节）
+     * @return 第i位对应ranges[i]；没有交换区间、偏移不在任何区间内或区间下标超过63时返回全1，即整体视为脏
+     */
+    unsigned long long SwapList::mask(int const offset)
+    {
+        int i = 0;
+        while (i < ranges.size() && i < 64)
+        {
+            if (offset >= ranges[i].offset && offset < ranges[i].offset + ranges[i].size)
+            {
+                return 1ULL << i;
+            }
+            i++;
+        }
+        return ~0ULL;
+    }
+
+    /**
+     * @brief 写端标记脏区间
+     * @param dirty 由mask()得到的脏位
+     */
+    void SwapList::mark(unsigned long long const dirty)
+    {
+        nodes[writeIndex]->dirty |= dirty;
+    }
+
+    /**
+     * @brief 获取写端节点内存
+     * @return 写端独占节点的内存指针，仅写端线程使用
+     */
+    unsigned char *SwapList::writer()
+    {
+        return nodes[writeIndex]->memPtr;
+    }
+
+    /**
+     * @brief 获取读端节点内存
+     * @return 读端独占节点的内存指针，仅读端线程使用，在两次fetch之间内容不变
+     */
+    unsigned char *SwapList::reader()
+    {
+        return nodes[readIndex]->memPtr;
+    }
+
+    /**
+     * @brief 写端提交当前节点
+     * @param carry 为真时把刚提交的内容复制到新的写端节点，供只改写部分字段的写端继续使用
+     * 
+     * 提交序号写入节点后以release语义把节点换入middle并置SWAP_FRESH，换回的节点成为新的写端节点；
+     * 若换回的节点仍带SWAP_FRESH，说明上一次提交尚未被读端取走，直接被本次提交覆盖。
+     * 节点的脏位图并入之前可能未被取走的提交的脏位，被覆盖的提交里改动过的区间因此不会丢失
+     */
+    void SwapList::commit(bool const carry)
+    {
+        SwapNode *node = nodes[writeIndex];
+        unsigned long long dirty = node->dirty;
+        node->dirty |= pending;
+        sequence++;
+        node->sequence = sequence;
+        int previous = middle.exchange(writeIndex | SWAP_FRESH, std::memory_order_acq_rel);
+        pending = (previous & SWAP_FRESH) ? node->dirty : dirty;
+        writeIndex = previous & SWAP_INDEX;
+        nodes[writeIndex]->dirty = 0;
+        if (carry)
+        {
+            memcpy(nodes[writeIndex]->memPtr, node->memPtr, size);
+        }
     }
 
     /**
-     * @brief 线程安全地前进到下一个节点
+     * @brief 读端取走最新提交的节点
+     * @return 有新提交的节点时返回true，否则读端节点保持不变并返回false
      * 
-     * 原子操作将当前节点指针移动到链表中的下一个节点
+     * 以acquire语义换入middle，保证读到的节点内容是写端提交时的完整内容
+     */
+    bool SwapList::fetch()
+    {
+        if ((middle.load(std::memory_order_relaxed) & SWAP_FRESH) == 0)
+        {
+            return false;
+        }
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & SWAP_INDEX;
+        return true;
+    }
+
+    /**
+     * @brief 获取读端节点的帧元数据
+     * @return 与reader()返回的数据属于同一次提交的元数据，仅读端线程使用
      */
-    void SwapList::advanceNodePtr()
+    FrameInfo const &SwapList::frame()
     {
-        nodePtr.store(nodePtr.load()->next);
+        return nodes[readIndex]->frame;
     }
 
     /**
-     * @brief 从链表复制数据到目标内存区域
+     * @brief 把最新提交的数据复制到目标内存区域
      * @param domainPtr 目标内存指针
      * @param domainSize 要复制的数据大小（字节）
+     * @param full 为真时复制全部交换区间；为假时只在取到新节点时复制其脏区间，域内存中其余字节保持上一次写入的内容
      * 
-     * 从当前节点的前一个节点复制数据到指定的内存区域
+     * 读端调用：先取最新提交的节点，再从读端节点复制，写端未提交新数据时重复发送上一帧；
+     * 设置了交换区间时只复制这些区间（如域中的RxPDO部分），不覆盖域内存中的其余字节
      */
-    void SwapList::copyTo(unsigned char *domainPtr, int const domainSize)
+    void SwapList::copyTo(unsigned char *domainPtr, int const domainSize, bool const full)
     {
-        memcpy(domainPtr, nodePtr.load()->previous->memPtr, domainSize);
+        bool fresh = fetch();
+        if (!full && !fresh)
+        {
+            return;
+        }
+        SwapNode const *node = nodes[readIndex];
+        unsigned long long dirty = full ? ~0ULL : node->dirty;
+        if (ranges.size() == 0)
+        {
+            if (dirty != 0)
+            {
+                memcpy(domainPtr, node->memPtr, domainSize);
+            }
+            return;
+        }
+        int i = 0;
+        while (i < ranges.size())
+        {
+            if (i >= 64 || (dirty >> i & 1ULL) != 0)
+            {
+                memcpy(domainPtr + ranges[i].offset, node->memPtr + ranges[i].offset, ranges[i].size);
+            }
+            i++;
+        }
     }
 
     /**
-     * @brief 从源内存区域复制数据到链表
+     * @brief 从源内存区域复制数据并提交
      * @param domainPtr 源内存指针
      * @param domainSize 要复制的数据大小（字节）
      * 
-     * 将数据复制到当前节点的下一个节点，并前进节点指针
+     * @param frame 帧元数据，为空时不写入元数据
+     * 
+     * 写端调用：整帧（或全部交换区间，如域中的TxPDO部分）覆盖写端节点后提交，无需把旧内容带入新的写端节点
      */
-    void SwapList::copyFrom(unsigned char const *domainPtr, int const domainSize)
+    void SwapList::copyFrom(unsigned char const *domainPtr, int const domainSize, FrameInfo const *frame)
     {
-        SwapNode *node = nodePtr.load();
-        memcpy(node->next->memPtr, domainPtr, domainSize);
-        nodePtr.store(node->next);
+        unsigned char *memPtr = nodes[writeIndex]->memPtr;
+        if (frame != nullptr)
+        {
+            nodes[writeIndex]->frame = *frame;
+        }
+        if (ranges.size() == 0)
+        {
+            memcpy(memPtr, domainPtr, domainSize);
+        }
+        else
+        {
+            int i = 0;
+            while (i < ranges.size())
+            {
+                memcpy(memPtr + ranges[i].offset, domainPtr + ranges[i].offset, ranges[i].size);
+                i++;
+            }
+        }
+        commit(false);
     }
 
     /**
      * @brief SwapList析构函数，释放所有节点内存
-     * 
-     * 遍历循环链表并删除所有节点，释放分配的内存
      */
     SwapList::~SwapList()
     {
-        SwapNode *current = nodePtr.load();
-        while (current != nullptr)
+        int i = 0;
+        while (i < 3)
+        {
+            delete nodes[i];
+            i++;
+        }
+    }
+
+    /**
+     * @brief SDOTable构造函数，清空所有完成槽
+     */
+    SDOTable::SDOTable()
+    {
+        int i = 0;
+        while (i < SDO_SLOT_COUNT)
+        {
+            slots[i].ticket.store(0, std::memory_order_relaxed);
+            slots[i].state.store(0, std::memory_order_relaxed);
+            slots[i].value.store(0, std::memory_order_relaxed);
+            i++;
+        }
+        ticket.store(0, std::memory_order_relaxed);
+        epoch.store(0, std::memory_order_relaxed);
+        slack.store(0, std::memory_order_relaxed);
+        deferred.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 从SDK内存区分配SDOTable对象
+     * @param size 对象大小（字节）
+     * @return 按缓存行对齐的内存
+     */
+    void *SDOTable::operator new(size_t const size)
+    {
+        return Arena::instance().allocate(size);
+    }
+
+    /**
+     * @brief 归还SDOTable对象的内存
+     * @param ptr 对象指针
+     */
+    void SDOTable::operator delete(void *ptr)
+    {
+        Arena::instance().release(ptr);
+    }
+
+    /**
+     * @brief 领取新票号，可由多个应用线程同时调用
+     * @return 非0的票号
+     */
+    unsigned int SDOTable::issue()
+    {
+        unsigned int issued = ticket.fetch_add(1, std::memory_order_relaxed) + 1;
+        while (issued == 0)
+        {
+            issued = ticket.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+        return issued;
+    }
+
+    /**
+     * @brief SDO线程写入已结束请求的结果
+     * @param msg 状态为3或-1的请求
+     *
+     * 先把槽位票号置0再写结果，最后发布票号；读端前后两次读到同一票号即说明结果完整
+     */
+    void SDOTable::complete(SDOMsg const &msg)
+    {
+        SDOSlot &slot = slots[msg.ticket & (SDO_SLOT_COUNT - 1)];
+        slot.ticket.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.state.store(msg.state, std::memory_order_relaxed);
+        slot.value.store(msg.value, std::memory_order_relaxed);
+        slot.ticket.store(msg.ticket, std::memory_order_release);
+    }
+
+    /**
+     * @brief 按票号取回请求结果
+     * @param msg 持有票号的请求，成功时写入state与value并清除票号
+     * @return 0：请求已结束；-1：尚未结束或没有票号
+     *
+     * 同一完成槽在其后第SDO_SLOT_COUNT个请求结束时被覆盖，覆盖前未取回的结果将无法再取回
+     */
+    int SDOTable::lookup(SDOMsg &msg)
+    {
+        if (msg.ticket == 0)
+        {
+            return -1;
+        }
+        SDOSlot &slot = slots[msg.ticket & (SDO_SLOT_COUNT - 1)];
+        if (slot.ticket.load(std::memory_order_acquire) != msg.ticket)
+        {
+            return -1;
+        }
+        short state = slot.state.load(std::memory_order_relaxed);
+        long value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.ticket.load(std::memory_order_relaxed) != msg.ticket)
+        {
+            return -1;
+        }
+        msg.state = state;
+        msg.value = value;
+        msg.ticket = 0;
+        return 0;
+    }
+
+    /**
+     * @brief Histogram构造函数，清零全部计数
+     */
+    Histogram::Histogram()
+    {
+        int i = 0;
+        while (i < HISTOGRAM_BUCKETS)
+        {
+            buckets[i].store(0, std::memory_order_relaxed);
+            i++;
+        }
+        count.store(0, std::memory_order_relaxed);
+        min.store(std::numeric_limits<unsigned long>::max(), std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 写入一个样本，只由一个线程调用，因此用读后写代替原子加
+     * @param sample 样本
+     */
+    void Histogram::record(unsigned long const sample)
+    {
+        int i = sample == 0 ? 0 : 64 - __builtin_clzl(sample);
+        if (i >= HISTOGRAM_BUCKETS)
+        {
+            i = HISTOGRAM_BUCKETS - 1;
+        }
+        buckets[i].store(buckets[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (sample < min.load(std::memory_order_relaxed))
+        {
+            min.store(sample, std::memory_order_relaxed);
+        }
+        if (sample > max.load(std::memory_order_relaxed))
+        {
+            max.store(sample, std::memory_order_relaxed);
+        }
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 读取当前计数，可由任意线程调用
+     * @param buckets 输出，HISTOGRAM_BUCKETS个桶
+     * @param count 输出，样本总数
+     * @param min 输出，最小样本，没有样本时为0
+     * @param max 输出，最大样本
+     */
+    void Histogram::read(unsigned long *buckets, unsigned long &count, unsigned long &min, unsigned long &max) const
+    {
+        count = this->count.load(std::memory_order_acquire);
+        min = count == 0 ? 0 : this->min.load(std::memory_order_relaxed);
+        max = this->max.load(std::memory_order_relaxed);
+        int i = 0;
+        while (i < HISTOGRAM_BUCKETS)
+        {
+            buckets[i] = this->buckets[i].load(std::memory_order_relaxed);
+            i++;
+        }
+    }
+
+    /**
+     * @brief 由桶计数估计分位数
+     * @param buckets HISTOGRAM_BUCKETS个桶
+     * @param count 样本总数
+     * @param max 最大样本
+     * @param q 分位，如0.99
+     * @return 第一个累计计数达到q * count的桶的上界，不超过max
+     */
+    unsigned long Histogram::quantile(unsigned long const *buckets, unsigned long const count, unsigned long const max, double const q)
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+        unsigned long target = (unsigned long)std::ceil(q * count), sum = 0;
+        int i = 0;
+        while (i < HISTOGRAM_BUCKETS - 1)
+        {
+            sum += buckets[i];
+            if (sum >= target)
+            {
+                break;
+            }
+            i++;
+        }
+        unsigned long upper = i == 0 ? 0 : (1UL << i) - 1;
+        return i == HISTOGRAM_BUCKETS - 1 || upper > max ? max : upper;
+    }
+
+    /**
+     * @brief CycleStats构造函数
+     */
+    CycleStats::CycleStats()
+    {
+        sequence.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        missed.store(0, std::memory_order_relaxed);
+        streak.store(0, std::memory_order_relaxed);
+        pending.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 写入前递增序号为奇数
+     */
+    void CycleStats::begin()
+    {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief 写入后递增序号为偶数
+     */
+    void CycleStats::end()
+    {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief SDOStats构造函数
+     */
+    SDOStats::SDOStats()
+    {
+        key.store(-1, std::memory_order_relaxed);
+        failures.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 记录一个已结束的请求
+     * @param msg 状态为3或-1的请求
+     * @param now 结束时间（CLOCK_MONOTONIC，纳秒）
+     */
+    void SDOStats::record(SDOMsg const &msg, long const now)
+    {
+        latency.record(now > msg.issued ? (now - msg.issued) / 1000 : 0);
+        retries.record(msg.retries);
+        if (msg.state < 0)
+        {
+            failures.store(failures.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 按线程名创建线程并设置调度策略、优先级与CPU集合
+     * @param pth 输出，线程标识
+     * @param name 线程名，对应配置文件<Thread name="...">，如ecat.0、ecat.0.sdo、rs485.0、imu
+     * @param routine 线程函数
+     * @param arg 线程函数参数
+     * @param cpus 配置文件未指定cpus时使用的CPU集合，为nullptr时不限制
+     * @param exclusive 为真时独占所得CPU集合
+     * @return 成功返回0，失败返回-1；实时调度因权限不足被拒绝时退回普通调度并仍返回0
+     */
+    int threadCreate(pthread_t *pth, char const *name, void *(*routine)(void *), void *arg, cpu_set_t const *cpus, bool const exclusive)
+    {
+        std::vector<std::string> thread = configXML->thread(name);
+        int policy = SCHED_OTHER, priority = 0;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        bool affinity = false;
+        if (cpus != nullptr)
+        {
+            cpuset = *cpus;
+            affinity = true;
+        }
+        if (thread.size() == 3)
+        {
+            if (thread[0] == "fifo")
+            {
+                policy = SCHED_FIFO;
+            }
+            else if (thread[0] == "rr")
+            {
+                policy = SCHED_RR;
+            }
+            else if (thread[0] != "other")
+            {
+                printf("%s thread policy should be fifo, rr or other, using other\n", name);
+            }
+            priority = policy == SCHED_OTHER ? 0 : atoi(thread[1].c_str());
+            if (priority < sched_get_priority_min(policy) || priority > sched_get_priority_max(policy))
+            {
+                printf("%s thread priority %d out of range, using %d\n", name, priority, sched_get_priority_min(policy));
+                priority = sched_get_priority_min(policy);
+            }
+            if (thread[2].size() > 0)
+            {
+                affinity = cpuList(thread[2].c_str(), cpuset) > 0;
+            }
+        }
+        cpu_set_t shared;
+        CPU_ZERO(&shared);
+        if (exclusive && !affinity)
+        {
+            printf("%s thread has no cpus to own\n", name);
+            return -1;
+        }
+        else if (exclusive)
+        {
+            cpu_set_t overlap;
+            CPU_AND(&overlap, &cpuset, &exclusiveCPUs);
+            if (CPU_COUNT(&overlap) > 0)
+            {
+                printf("%s thread cpus already owned by another thread\n", name);
+                return -1;
+            }
+            CPU_OR(&exclusiveCPUs, &exclusiveCPUs, &cpuset);
+        }
+        else
+        {
+            // 非独占线程避开独占CPU；扣除后为空时保持原集合
+            if (!affinity)
+            {
+                int i = 0;
+                while (i < sysconf(_SC_NPROCESSORS_ONLN) && i < CPU_SETSIZE)
+                {
+                    CPU_SET(i, &cpuset);
+                    i++;
+                }
+            }
+            shared = cpuset;
+            cpu_set_t remaining;
+            CPU_XOR(&remaining, &cpuset, &exclusiveCPUs);
+            CPU_AND(&remaining, &remaining, &cpuset);
+            if (CPU_COUNT(&remaining) > 0)
+            {
+                cpuset = remaining;
+                affinity = affinity || CPU_COUNT(&exclusiveCPUs) > 0;
+            }
+        }
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (affinity)
+        {
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+        }
+        if (policy != SCHED_OTHER)
+        {
+            struct sched_param param;
+            param.sched_priority = priority;
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, policy);
+            pthread_attr_setschedparam(&attr, &param);
+        }
+        int res = pthread_create(pth, &attr, routine, arg);
+        if (res == EPERM && policy != SCHED_OTHER)
+        {
+            printf("%s thread policy %s not permitted, using other\n", name, thread[0].c_str());
+            pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+            policy = SCHED_OTHER;
+            priority = 0;
+            res = pthread_create(pth, &attr, routine, arg);
+        }
+        pthread_attr_destroy(&attr);
+        if (res != 0)
+        {
+            return -1;
+        }
+        if (exclusive && affinity)
+        {
+            // 从此前创建的非独占线程中收回新的独占CPU
+            int i = 0;
+            while (i < sharedThreads.size())
+            {
+                cpu_set_t remaining;
+                CPU_XOR(&remaining, &sharedCPUs[i], &exclusiveCPUs);
+                CPU_AND(&remaining, &remaining, &sharedCPUs[i]);
+                if (CPU_COUNT(&remaining) > 0)
+                {
+                    pthread_setaffinity_np(sharedThreads[i], sizeof(cpu_set_t), &remaining);
+                }
+                i++;
+            }
+        }
+        else if (!exclusive)
+        {
+            sharedThreads.push_back(*pth);
+            sharedCPUs.push_back(shared);
+        }
+        printf("%s thread: policy %d, priority %d,%s cpus", name, policy, priority, exclusive ? " exclusive" : "");
+        int i = 0;
+        while (affinity && i < CPU_SETSIZE)
+        {
+            if (CPU_ISSET(i, &cpuset))
+            {
+                printf(" %d", i);
+            }
+            i++;
+        }
+        printf(affinity ? "\n" : " all\n");
+        return 0;
+    }
+
+    /**
+     * @brief 解析CPU列表
+     * @param list CPU列表，如"3"或"0-2,5"
+     * @param cpuset 输出，CPU集合
+     * @return CPU数量
+     */
+    int cpuList(char const *list, cpu_set_t &cpuset)
+    {
+        CPU_ZERO(&cpuset);
+        char const *ptr = list;
+        while (*ptr != '\0')
+        {
+            char *end = nullptr;
+            long first = strtol(ptr, &end, 10), last = first;
+            if (end == ptr)
+            {
+                break;
+            }
+            if (*end == '-')
+            {
+                ptr = end + 1;
+                last = strtol(ptr, &end, 10);
+            }
+            while (first <= last && first < CPU_SETSIZE)
+            {
+                CPU_SET(first, &cpuset);
+                first++;
+            }
+            ptr = *end == ',' ? end + 1 : end;
+        }
+        return CPU_COUNT(&cpuset);
+    }
+
+    /**
+     * @brief 读取内核隔离的CPU
+     * @param cpuset 输出，isolcpus与nohz_full指定的CPU的并集
+     * @return CPU数量
+     */
+    int isolatedCPUs(cpu_set_t &cpuset)
+    {
+        CPU_ZERO(&cpuset);
+        char const *files[2] = {"/sys/devices/system/cpu/isolated", "/sys/devices/system/cpu/nohz_full"};
+        int i = 0;
+        while (i < 2)
+        {
+            FILE *file = fopen(files[i], "r");
+            if (file == nullptr)
+            {
+                i++;
+                continue;
+            }
+            char list[256] = {0};
+            if (fgets(list, sizeof(list), file) != nullptr)
+            {
+                list[strcspn(list, "\n")] = '\0';
+                cpu_set_t tmp;
+                cpuList(list, tmp);
+                CPU_OR(&cpuset, &cpuset, &tmp);
+            }
+            fclose(file);
+            i++;
+        }
+        return CPU_COUNT(&cpuset);
+    }
+
+    /**
+     * @brief 预先触及线程栈，在线程函数开始处调用
+     */
+    void stackPrefault()
+    {
+        volatile unsigned char stack[STACK_PREFAULT];
+        int i = 0;
+        while (i < STACK_PREFAULT)
         {
-            SwapNode *node = current;
-            current = current->next;
-            node->previous->next = nullptr;
-            delete node;
+            stack[i] = 0;
+            i += 4096;
         }
     }
 
@@ -133,6 +803,9 @@ namespace DriverSDK
         countBias = 0.0;
         polarity = encoderResolution = gearRatioTor = gearRatioPosVel = ratedCurrent = torqueConstant = ratedTorque = maximumTorque = maximumPosition = 1.0;
         minimumPosition = -1.0;
+        temperature.store(0);
+        statusWord.store(0);
+        mode.store(8);
     }
 
     /**
@@ -17,34 +17,85 @@
 
 #pragma once                                                               // 防止头文件重复包含的预处理指令
 
+#include "arena.h"                                                         // 包含SDK内存区头文件
 #include <ecrt.h>                                                          // 包含EtherCAT实时库头文件
 #include <string>                                                          // 包含C++标准字符串库
+#include <vector>                                                          // 包含C++标准向量库
 #include <atomic>                                                          // 包含C++原子操作库
+#include <functional>                                                      // 包含C++函数对象库
+#include <pthread.h>                                                       // 包含POSIX线程库
 
 #define NSEC_PER_SEC 1000000000L                                           // 定义每秒的纳秒数常量
 #define TIMESPEC2NS(T) T.tv_sec *NSEC_PER_SEC + T.tv_nsec                 // 定义时间结构体转换为纳秒的宏
+#define TIMING_SLEEP 0                                                     // 周期等待：clock_nanosleep睡眠到绝对时刻
+#define TIMING_HYBRID 1                                                    // 周期等待：睡眠到自旋窗口起点，再轮询时钟
+#define TIMING_SPIN 2                                                      // 周期等待：全程轮询时钟，独占所在CPU
+#define OVERRUN_CATCHUP 0                                                  // 周期超时：保持相位，错过的周期立即连续补发
+#define OVERRUN_SKIP 1                                                     // 周期超时：保持相位，跳过已错过的周期，周期计数随之前进
+#define OVERRUN_REPHASE 2                                                  // 周期超时：以发送完成时刻为新相位重新计时
+#define STACK_PREFAULT (256 * 1024)                                        // 线程启动时预先触及的栈字节数
 
 namespace DriverSDK                                                        // 定义驱动SDK命名空间
 {                                                                          // 命名空间开始
+    // 定义帧元数据结构体，描述节点中数据来自哪个总线周期
+    struct FrameInfo                                                       
+    {                                                                      
+        unsigned long cycle;                                               // 总线周期计数
+        long rxTime;                                                       // 接收时间，CLOCK_MONOTONIC纳秒
+        long dcTime;                                                       // 该周期的DC应用时间（纳秒），未启用DC时为0
+        int workingCounter;                                                // 工作计数器
+        int wcState;                                                       // 工作计数器状态，取值同ec_wc_state_t
+    };                                                                     
+
     // 定义交换节点类
     class SwapNode                                                         
     {                                                                      
     public:                                                                
         unsigned char *memPtr;                                             // 内存指针，指向数据缓冲区
-        SwapNode *previous, *next;                                         // 前一个和后一个节点指针，形成双向链表
+        unsigned long sequence;                                            // 提交序号，写端每次提交时递增
+        unsigned long long dirty;                                          // 脏区间位图，第i位对应SwapList::ranges[i]
+        FrameInfo frame;                                                   // 帧元数据，随节点一起提交
         SwapNode(int const size);                                          // 构造函数声明，参数为缓冲区大小
+        static void *operator new(size_t const size);                      // 从SDK内存区分配，节点各自独占缓存行
+        static void operator delete(void *ptr);                            // 归还到SDK内存区
         ~SwapNode();                                                       // 析构函数声明
     };                                                                    
 
-    // 定义交换列表类
+    // 定义交换区间结构体，描述节点中需要与域内存交换的一段字节
+    struct SwapRange                                                       
+    {                                                                      
+        int offset;                                                        // 区间起始偏移（字节）
+        int size;                                                          // 区间长度（字节）
+    };                                                                     
+
+#define SWAP_INDEX 0x3                                                     // 中间节点下标掩码
+#define SWAP_FRESH 0x4                                                     // 中间节点已提交且尚未被读端取走
+
+    // 定义交换列表类：单写单读三缓冲，写端与读端各自独占一个节点，通过原子交换中间节点传递最新的完整数据帧
     class SwapList                                                         
     {                                                                      
     public:                                                                
-        std::atomic<SwapNode *> nodePtr;                                   // 原子操作的节点指针，用于线程安全
+        int size;                                                          // 节点大小（字节）
+        SwapNode *nodes[3];                                                // 三个缓冲节点
+        std::vector<SwapRange> ranges;                                     // 与域内存交换的区间，按偏移升序且互不相邻；为空时交换整个节点
+        alignas(CACHE_LINE_SIZE) int writeIndex;                           // 写端独占的节点下标，以下至middle前的成员仅由写端访问
+        unsigned long sequence;                                            // 写端提交计数
+        unsigned long long pending;                                        // 已提交但可能尚未被读端取走的脏区间位图
+        alignas(CACHE_LINE_SIZE) std::atomic<int> middle;                  // 共享的中间节点下标及SWAP_FRESH标志，单独占一个缓存行
+        alignas(CACHE_LINE_SIZE) int readIndex;                            // 读端独占的节点下标，仅由读端访问
         SwapList(int const size);                                          // 构造函数声明，参数为节点大小
-        void advanceNodePtr();                                             // 前进节点指针的方法声明
-        void copyTo(unsigned char *domainPtr, int const domainSize);       // 复制数据到域指针的方法声明
-        void copyFrom(unsigned char const *domainPtr, int const domainSize);// 从域指针复制数据的方法声明
+        static void *operator new(size_t const size);                      // 从SDK内存区按缓存行对齐分配
+        static void operator delete(void *ptr);                            // 归还到SDK内存区
+        void addRange(int const offset, int const size);                   // 添加交换区间，与已有区间重叠或相邻时合并
+        unsigned long long mask(int const offset);                         // 偏移所在交换区间对应的脏位，找不到或超过64个区间时返回全1
+        void mark(unsigned long long const dirty);                         // 写端标记脏区间
+        unsigned char *writer();                                           // 写端节点内存
+        unsigned char *reader();                                           // 读端节点内存，在两次fetch之间保持不变
+        void commit(bool const carry = true);                              // 写端提交当前节点，carry为真时把提交的内容带入新的写端节点
+        bool fetch();                                                      // 读端取走最新提交的节点，有新节点时返回true；只允许一个读端，多线程读取须在外部串行
+        FrameInfo const &frame();                                          // 读端节点的帧元数据，与reader()属于同一帧
+        void copyTo(unsigned char *domainPtr, int const domainSize, bool const full = true); // 读端：取最新节点并把交换区间（full为假时仅脏区间）复制到域内存
+        void copyFrom(unsigned char const *domainPtr, int const domainSize, FrameInfo const *frame = nullptr); // 写端：从域内存复制交换区间，附上帧元数据后提交
         ~SwapList();                                                       // 析构函数声明
     };                                                                     
 
@@ -60,9 +111,119 @@ namespace DriverSDK                                                        // 
         unsigned char signed_;   // 0: unsigned; 1: signed                 // 符号标识：0无符号，1有符号
         unsigned char bitLength; // 8, 16 or 32                           // 位长度：8、16或32位
         unsigned char operation; // 0: write; 1: read                     // 操作类型：0写入，1读取
-        int recycled;                                                      // 回收标识
+        unsigned int ticket;                                               // 请求票号，0表示没有未取回的请求
+        unsigned char priority;                                            // 优先级通道：0普通，1优先
+        long deadline;                                                     // 截止时间（CLOCK_MONOTONIC，纳秒），超过后请求以-1结束
+        long issued;                                                       // 提交时间（CLOCK_MONOTONIC，纳秒）
+        unsigned short retries;                                            // 从站返回错误后重新发起的次数
+        std::function<void(SDOMsg const &)> *callback;                     // 完成回调，在SDO线程中调用；为空时结果写入完成槽
     };                                                                     
 
+#define SDO_HANDLE_COUNT 1024                                              // 对象字典句柄表容量
+#define SDO_LANES 2                                                        // SDO优先级通道数量
+#define SDO_TIMEOUT 500                                                    // SDO请求默认超时（毫秒）
+#define SDO_SLOT_COUNT 1024                                                // 完成槽数量，须为2的幂
+#define SDO_STAT_OBJECTS 64                                                // 每个主站按对象统计的对象数量上限
+#define HISTOGRAM_BUCKETS 24                                               // 直方图桶数量
+
+    // 定义对象字典句柄表项结构体，对象名按设备类型解析一次后以整数句柄引用
+    struct SDOEntry                                                        
+    {                                                                      
+        int type;                                                          // 设备类型下标
+        unsigned short index;                                              // SDO索引值
+        unsigned char subindex;                                            // SDO子索引值
+        unsigned char signed_;                                             // 符号标识：0无符号，1有符号
+        unsigned char bitLength;                                           // 位长度：8、16或32位
+        unsigned char operation;                                           // 操作类型：0写入，1读取
+    };                                                                     
+
+    // 定义SDO完成槽结构体，由SDO线程写入、应用线程读取
+    struct SDOSlot                                                         
+    {                                                                      
+        std::atomic<unsigned int> ticket;                                  // 已完成请求的票号，写入结果期间为0
+        std::atomic<short> state;                                          // 完成状态：-1错误，3完成
+        std::atomic<long> value;                                           // SDO数值
+    };                                                                     
+
+    // 定义SDO缓存项结构体，仅由SDO线程访问
+    struct SDOCache                                                        
+    {                                                                      
+        unsigned int key;                                                  // (index << 8) | subindex
+        bool valid;                                                        // 缓存值是否有效
+        long value;                                                        // 最近一次成功读取的值
+    };                                                                     
+
+    // 定义SDO票号表类：每个请求领取唯一票号，SDO线程按票号把结果写入对应完成槽，应用线程按票号直接查找，与在途请求数量无关
+    class SDOTable                                                         
+    {                                                                      
+    public:                                                                
+        SDOSlot slots[SDO_SLOT_COUNT];                                     // 完成槽，按票号低位索引
+        alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> ticket;         // 最近发出的票号
+        alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> epoch;          // 从站状态变化计数，由实时线程递增，SDO线程据此清空缓存
+        std::atomic<long> slack;                                           // 实时线程上一周期剩余时间（纳秒）
+        std::atomic<unsigned long> deferred;                               // 因周期余量不足被推迟的SDO发起次数
+        SDOTable();                                                        // 构造函数声明
+        static void *operator new(size_t const size);                      // 从SDK内存区按缓存行对齐分配
+        static void operator delete(void *ptr);                            // 归还到SDK内存区
+        unsigned int issue();                                              // 领取新票号，不为0
+        void complete(SDOMsg const &msg);                                  // SDO线程：写入已结束请求的结果
+        int lookup(SDOMsg &msg);                                           // 应用线程：请求已结束时取回结果、清除票号并返回0，否则返回-1
+    };                                                                     
+
+    // 定义直方图类：第0桶统计0，第k桶统计[2^(k-1), 2^k)，最后一桶包含以上全部；
+    // 只允许一个线程写入，各计数为独立原子变量，读端不加锁，读到的各桶之间可能相差正在写入的一个样本
+    class Histogram                                                        
+    {                                                                      
+    public:                                                                
+        std::atomic<unsigned long> buckets[HISTOGRAM_BUCKETS];             // 各桶样本数
+        std::atomic<unsigned long> count;                                  // 样本总数
+        std::atomic<unsigned long> min;                                    // 最小样本
+        std::atomic<unsigned long> max;                                    // 最大样本
+        Histogram();                                                       // 构造函数声明
+        void record(unsigned long const sample);                           // 写入一个样本
+        void read(unsigned long *buckets, unsigned long &count, unsigned long &min, unsigned long &max) const; // 读取当前计数，没有样本时min为0
+        static unsigned long quantile(unsigned long const *buckets, unsigned long const count, unsigned long const max, double const q); // 由桶计数估计分位数，取所在桶的上界且不超过max
+    };                                                                     
+
+    // 定义总线周期统计类：实时线程每周期分两段写入，每段写入前后各递增一次序号，读端在序号为偶数且前后一致时得到同一时刻的快照
+    class CycleStats                                                       
+    {                                                                      
+    public:                                                                
+        std::atomic<unsigned int> sequence;                                // 序号，为奇数时正在写入
+        std::atomic<unsigned long> overruns;                               // 发送完成时已超过下一周期起点的周期数
+        std::atomic<unsigned long> missed;                                 // 超时后跳过或重新计时所放弃的周期数
+        std::atomic<unsigned long> streak;                                 // 最长的连续超时周期数
+        std::atomic<unsigned int> pending;                                 // 待回调的连续超时周期数，由实时线程发布、SDO线程取走并调用回调，0为无
+        Histogram lateness;                                                // 唤醒时刻相对周期起点的延迟（纳秒）
+        Histogram send;                                                    // 唤醒到同一周期ecrt_master_send返回（纳秒）
+        Histogram process;                                                 // ecrt_master_receive返回到处理完全部域（纳秒）
+        Histogram loop;                                                    // 唤醒到同一周期处理完全部域（纳秒）
+        CycleStats();                                                      // 构造函数声明
+        void begin();                                                      // 写入前调用
+        void end();                                                        // 写入后调用
+    };                                                                     
+
+    // 定义SDO统计结构体，由SDO线程写入
+    struct SDOStats                                                        
+    {                                                                      
+        std::atomic<int> key;                                              // 按对象统计时为(index << 8) | subindex，未使用为-1
+        Histogram latency;                                                 // 提交到完成的时间（微秒）
+        Histogram retries;                                                 // 每个请求的重试次数
+        std::atomic<unsigned long> failures;                               // 以-1结束的请求数
+        SDOStats();                                                        // 构造函数声明
+        void record(SDOMsg const &msg, long const now);                    // 记录一个已结束的请求
+    };                                                                     
+
+    // 按配置文件<Threads>中同名<Thread>设置调度策略、优先级与CPU集合后创建线程；未配置CPU集合时使用cpus，为空则不限制。
+    // exclusive为真时线程独占其CPU集合，此前与此后创建的非独占SDK线程都不再运行在这些CPU上
+    int threadCreate(pthread_t *pth, char const *name, void *(*routine)(void *), void *arg, cpu_set_t const *cpus, bool const exclusive = false);
+    // 解析CPU列表，如"3"或"0-2,5"，返回CPU数量
+    int cpuList(char const *list, cpu_set_t &cpuset);
+    // 内核隔离的CPU（isolcpus与nohz_full的并集），返回CPU数量
+    int isolatedCPUs(cpu_set_t &cpuset);
+    // 逐页写入STACK_PREFAULT字节的栈，实时线程运行中不再因栈缺页陷入内核
+    void stackPrefault();
+
     // 定义驱动器接收数据结构体
     struct DriverRxData                                                    
     {                                                                      
@@ -94,6 +255,9 @@ namespace DriverSDK                                                        // 
     public:                                                                
         float polarity, countBias, encoderResolution, gearRatioTor, gearRatioPosVel, ratedCurrent, torqueConstant, ratedTorque, maximumTorque, minimumPosition, maximumPosition; // 电机相关参数：极性、计数偏差、编码器分辨率、扭矩齿轮比、位置速度齿轮比、额定电流、扭矩常数、额定扭矩、最大扭矩、最小位置、最大位置
         SDOMsg sdoTemplate, temperatureSDO, clearErrorSDO;                 // SDO消息模板、温度SDO、清除错误SDO
+        std::atomic<short> temperature;                                    // 温度缓存，由ECAT线程轮询写入
+        std::atomic<unsigned short> statusWord;                            // 最近一帧的状态字，由ECAT实时线程写入，供SDO线程判断驱动器是否在线
+        std::atomic<char> mode;                                            // 操作模式，由应用线程写入，ECAT实时线程每周期写入域内存
         MotorParameters();                                                 // 构造函数声明
         int load(std::string const &bus, int const alias, std::string const &type, ec_sdo_request_t *const sdoHandler); // 加载参数方法声明
         ~MotorParameters();                                                // 析构函数声明
@@ -231,13 +395,16 @@ namespace DriverSDK                                                        // 
     public:                                                                
         Data *data;                                                        
         int offset;                                                        // 数据偏移量
+        bool output;                                                       // 真：应用写、总线读（rx）；假：总线写、应用读（tx）
+        unsigned long long dirty;                                          // 数据所在交换区间的脏位
         SwapList *swap;                                                    // 交换列表指针
          // 构造函数定义
         DataWrapper()                                                     
         {                                                                  
-            data = new Data();                                             
-            memset(data, 0, sizeof(Data));                                 
+            data = (Data *)Arena::instance().allocate(sizeof(Data));       // 从SDK内存区分配，已清零
             offset = -1;                                                   
+            output = false;                                                
+            dirty = 0;                                                     
             swap = nullptr;                                                
         }                                                                  
         // 初始化方法定义
@@ -246,23 +413,39 @@ namespace DriverSDK                                                        // 
             this->offset = offset;                                         
         }                                                                  
         // 配置方法定义
-        void config(SwapList *const swap)                                  
+        void config(SwapList *const swap, bool const output)               
         {                                                                  
             this->swap = swap;                                             
+            this->output = output;                                         
+            dirty = swap->mask(offset);                                    
         }                                                                  
-        // 箭头操作符重载定义
+        // 箭头操作符重载定义，应用线程视图：rx指向写端节点并标记脏区间，tx指向读端节点
         Data *operator->()                                                 
         {                                                                  
             if (swap != nullptr)                                         
             {                                                              
-                return (Data *)(swap->nodePtr.load()->memPtr + offset);    // 返回交换列表中对应偏移位置的数据指针
+                if (output)                                                
+                {                                                          
+                    swap->mark(dirty);                                     
+                    return (Data *)(swap->writer() + offset);              
+                }                                                          
+                return (Data *)(swap->reader() + offset);                  
+            }                                                              
+            return data;                                                   
+        }                                                                  
+        // 总线线程视图：rx指向读端节点，tx指向写端节点
+        Data *bus()                                                        
+        {                                                                  
+            if (swap != nullptr)                                         
+            {                                                              
+                return (Data *)((output ? swap->reader() : swap->writer()) + offset);
             }                                                              
             return data;                                                   
         }                                                                  
         // 析构函数定义
         ~DataWrapper()                                                     
         {                                                                 
-            delete data;                                                   
+            Arena::instance().release(data);                               
         }                                                                  
     };                                                                    
 
@@ -271,7 +454,9 @@ namespace DriverSDK                                                        // 
     class WrapperPair                                                      
     {                                                                      
     public:                                                                
-        int order, domain, slave, alias, enabled;                         // 顺序、域、从站、别名、启用状态
+        int order, domain, slave, alias;                                   // 顺序、域、从站、别名
+        int enabled;                                                       // 启用状态，转换器为已处理的通道序号，仅ECAT周期线程使用
+        std::atomic<int> desired;                                          // 驱动器期望的CiA 402状态，由应用线程写、ECAT周期线程读
         std::string bus, type;                                             // 总线名称、类型字符串
         DataWrapper<RxData> rx;                                            // 接收数据包装器
         DataWrapper<TxData> tx;                                            // 发送数据包装器
@@ -285,6 +470,7 @@ namespace DriverSDK                                                        // 
             slave = -1;                                                    
             alias = 0;                                                     
             enabled = 0;                                                   
+            desired = 0;                                                   
             bus = "";                                                      
             type = "";                                                     
             sdoHandler = nullptr;                                          
@@ -319,8 +505,8 @@ namespace DriverSDK                                                        // 
             {                                                               
                 return 1;                                                   
             }                                                              
-            rx.config(rxSwap);                                             // 配置接收数据包装器的交换列表
-            tx.config(txSwap);                                             // 配置发送数据包装器的交换列表
+            rx.config(rxSwap, true);                                       // 配置接收数据包装器的交换列表
+            tx.config(txSwap, false);                                      // 配置发送数据包装器的交换列表
             if (parameters.load(bus, alias, type, sdoHandler) < 0)       
             {                                                              
                 printf("loading parameters failed for %s slave %d:%d with alias %d\n", bus.c_str(), order, slave, alias); 
@@ -131,6 +131,32 @@ namespace DriverSDK
         return xmlDoc.FirstChildElement("Config")->FirstChildElement("IMU")->IntAttribute("baudrate");
     }
 
+    // 线程配置{policy, priority, cpus}，未配置时为空
+    std::vector<std::string> ConfigXML::thread(char const *name)
+    {
+        std::vector<std::string> ret;
+        tinyxml2::XMLElement *threadsElement = xmlDoc.FirstChildElement("Config")->FirstChildElement("Threads");
+        if (threadsElement == nullptr)
+        {
+            return ret;
+        }
+        tinyxml2::XMLElement *threadElement = threadsElement->FirstChildElement("Thread");
+        while (threadElement != nullptr)
+        {
+            char const *threadName = threadElement->Attribute("name");
+            if (threadName != nullptr && strcmp(threadName, name) == 0)
+            {
+                char const *policy = threadElement->Attribute("policy"), *cpus = threadElement->Attribute("cpus");
+                ret.push_back(policy == nullptr ? "other" : policy);
+                ret.push_back(std::to_string(threadElement->IntAttribute("priority", 0)));
+                ret.push_back(cpus == nullptr ? "" : cpus);
+                return ret;
+            }
+            threadElement = threadElement->NextSiblingElement("Thread");
+        }
+        return ret;
+    }
+
     std::string ConfigXML::device(char const *bus, int const order, char const *name)
     {
         tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
@@ -187,6 +213,92 @@ namespace DriverSDK
         return false;
     }
 
+    int ConfigXML::refresh(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                return masterElement->IntAttribute("refresh", 1000);
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return 1000;
+    }
+
+    std::string ConfigXML::timing(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                char const *timing = masterElement->Attribute("timing");
+                return timing == nullptr ? "hybrid" : timing;
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return "hybrid";
+    }
+
+    long ConfigXML::spin(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                return masterElement->Int64Attribute("spin", 0);
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return 0;
+    }
+
+    std::string ConfigXML::overrun(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                char const *overrun = masterElement->Attribute("overrun");
+                return overrun == nullptr ? "catchup" : overrun;
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return "catchup";
+    }
+
+    int ConfigXML::overrunLimit(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                return masterElement->IntAttribute("overrun_limit", 0);
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return 0;
+    }
+
+    bool ConfigXML::exclusive(char const *bus, int const order)
+    {
+        tinyxml2::XMLElement *masterElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Masters")->FirstChildElement("Master");
+        while (masterElement != nullptr)
+        {
+            if (masterElement->IntAttribute("order") == order)
+            {
+                return masterElement->BoolAttribute("exclusive");
+            }
+            masterElement = masterElement->NextSiblingElement("Master");
+        }
+        return false;
+    }
+
     tinyxml2::XMLElement *ConfigXML::busDevice(char const *bus, char const *VendorID, char const *ProductCode)
     {
         tinyxml2::XMLElement *deviceElement = xmlDoc.FirstChildElement("Config")->FirstChildElement(bus)->FirstChildElement("Devices")->FirstChildElement("Device");
@@ -291,6 +403,23 @@ namespace DriverSDK
         return ret;
     }
 
+    // 字典中标记cacheable="1"的对象，按(index << 8) | subindex返回
+    std::vector<unsigned int> ConfigXML::cacheable(tinyxml2::XMLElement *const deviceElement)
+    {
+        std::vector<unsigned int> ret;
+        tinyxml2::XMLElement *dictionaryElement = deviceElement->FirstChildElement("Dictionary");
+        tinyxml2::XMLElement *objectElement = dictionaryElement->FirstChildElement("Object");
+        while (objectElement != nullptr)
+        {
+            if (objectElement->IntAttribute("cacheable", 0) == 1)
+            {
+                ret.push_back((unsigned int)strtoul(objectElement->Attribute("index"), nullptr, 16) << 8 | (unsigned int)strtoul(objectElement->Attribute("subindex"), nullptr, 16));
+            }
+            objectElement = objectElement->NextSiblingElement("Object");
+        }
+        return ret;
+    }
+
     std::vector<std::map<int, std::string>> ConfigXML::alias2type(char const *bus)
     {
         std::vector<std::map<int, std::string>> ret;
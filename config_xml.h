@@ -37,10 +37,17 @@ namespace DriverSDK
         int dof(char const *bus, char const *type);
         std::string imuDevice();
         int imuBaudrate();
+        std::vector<std::string> thread(char const *name);
         std::string device(char const *bus, int const order, char const *name);
         int baudrate(char const *bus, int const order);
         long period(char const *bus, int const order);
         bool dc(char const *bus, int const order);
+        int refresh(char const *bus, int const order);
+        std::string timing(char const *bus, int const order);
+        long spin(char const *bus, int const order);
+        std::string overrun(char const *bus, int const order);
+        int overrunLimit(char const *bus, int const order);
+        bool exclusive(char const *bus, int const order);
         tinyxml2::XMLElement *busDevice(char const *bus, char const *VendorID, char const *ProductCode);
         tinyxml2::XMLElement *busDevice(char const *bus, char const *type);
         std::string type(tinyxml2::XMLElement const *deviceElement);
@@ -49,6 +56,7 @@ namespace DriverSDK
         unsigned int productCode(tinyxml2::XMLElement const *deviceElement);
         std::vector<std::vector<std::string>> pdos(tinyxml2::XMLElement *const deviceElement, char const *rxtx);
         std::vector<std::string> entry(tinyxml2::XMLElement *const deviceElement, char const *object);
+        std::vector<unsigned int> cacheable(tinyxml2::XMLElement *const deviceElement);
         std::vector<std::map<int, std::string>> alias2type(char const *bus);
         std::vector<std::map<int, int>> alias2domain(char const *bus);
         tinyxml2::XMLError save();
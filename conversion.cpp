@@ -0,0 +1,317 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+#include "conversion.h"
+#include "loong_driver_sdk.h"
+#include <string.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace DriverSDK
+{
+    // 标量实现，也用于向量实现处理不足一个向量的尾部
+    static void targetScalar(MotorConversion const &c, int const begin, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque)
+    {
+        int i = begin;
+        while (i < count)
+        {
+            double p = pos[i];
+            if (p < c.positionMin[i])
+            {
+                p = c.positionMin[i];
+            }
+            else if (p > c.positionMax[i])
+            {
+                p = c.positionMax[i];
+            }
+            position[i] = p * c.positionScale[i] + c.positionBias[i];
+            velocity[i] = vel[i] * c.positionScale[i];
+            double t = tor[i];
+            if (t > c.torqueMax[i])
+            {
+                t = c.torqueMax[i];
+            }
+            else if (t < -c.torqueMax[i])
+            {
+                t = -c.torqueMax[i];
+            }
+            torque[i] = t * c.torqueScale[i];
+            i++;
+        }
+    }
+
+    static void actualScalar(MotorConversion const &c, int const begin, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor)
+    {
+        int i = begin;
+        while (i < count)
+        {
+            pos[i] = (position[i] - c.positionBias[i]) * c.actualPositionScale[i];
+            vel[i] = velocity[i] * c.actualPositionScale[i];
+            tor[i] = torque[i] * c.actualTorqueScale[i];
+            i++;
+        }
+    }
+
+    static void targetScalar(MotorConversion const &c, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque)
+    {
+        targetScalar(c, 0, count, pos, vel, tor, position, velocity, torque);
+    }
+
+    static void actualScalar(MotorConversion const &c, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor)
+    {
+        actualScalar(c, 0, count, position, velocity, torque, pos, vel, tor);
+    }
+
+#if defined(__x86_64__)
+    // SSE2：每次处理2个关节，系数数组按缓存行对齐，用户数组不要求对齐
+    static void targetSSE2(MotorConversion const &c, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque)
+    {
+        int i = 0;
+        while (i + 2 <= count)
+        {
+            __m128d scale = _mm_load_pd(c.positionScale + i);
+            __m128d p = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const *)(pos + i))));
+            p = _mm_min_pd(_mm_max_pd(p, _mm_load_pd(c.positionMin + i)), _mm_load_pd(c.positionMax + i));
+            _mm_storel_epi64((__m128i *)(position + i), _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(p, scale), _mm_load_pd(c.positionBias + i))));
+            __m128d v = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const *)(vel + i))));
+            _mm_storel_epi64((__m128i *)(velocity + i), _mm_cvttpd_epi32(_mm_mul_pd(v, scale)));
+            __m128d maximum = _mm_load_pd(c.torqueMax + i);
+            __m128d t = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((__m128i const *)(tor + i))));
+            t = _mm_max_pd(_mm_min_pd(t, maximum), _mm_sub_pd(_mm_setzero_pd(), maximum));
+            _mm_storel_epi64((__m128i *)(torque + i), _mm_cvttpd_epi32(_mm_mul_pd(t, _mm_load_pd(c.torqueScale + i))));
+            i += 2;
+        }
+        targetScalar(c, i, count, pos, vel, tor, position, velocity, torque);
+    }
+
+    static void actualSSE2(MotorConversion const &c, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor)
+    {
+        int i = 0;
+        while (i + 2 <= count)
+        {
+            __m128d scale = _mm_load_pd(c.actualPositionScale + i);
+            __m128d p = _mm_cvtepi32_pd(_mm_loadl_epi64((__m128i const *)(position + i)));
+            _mm_storel_pi((__m64 *)(pos + i), _mm_cvtpd_ps(_mm_mul_pd(_mm_sub_pd(p, _mm_load_pd(c.positionBias + i)), scale)));
+            __m128d v = _mm_cvtepi32_pd(_mm_loadl_epi64((__m128i const *)(velocity + i)));
+            _mm_storel_pi((__m64 *)(vel + i), _mm_cvtpd_ps(_mm_mul_pd(v, scale)));
+            __m128d t = _mm_cvtepi32_pd(_mm_loadl_epi64((__m128i const *)(torque + i)));
+            _mm_storel_pi((__m64 *)(tor + i), _mm_cvtpd_ps(_mm_mul_pd(t, _mm_load_pd(c.actualTorqueScale + i))));
+            i += 2;
+        }
+        actualScalar(c, i, count, position, velocity, torque, pos, vel, tor);
+    }
+
+    // AVX2：每次处理4个关节；不使用FMA，保证与标量实现逐位一致；处理尾部前清除YMM高位，避免与SSE指令混用时的状态切换开销
+    __attribute__((target("avx2"))) static void targetAVX2(MotorConversion const &c, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque)
+    {
+        int i = 0;
+        while (i + 4 <= count)
+        {
+            __m256d scale = _mm256_load_pd(c.positionScale + i);
+            __m256d p = _mm256_cvtps_pd(_mm_loadu_ps(pos + i));
+            p = _mm256_min_pd(_mm256_max_pd(p, _mm256_load_pd(c.positionMin + i)), _mm256_load_pd(c.positionMax + i));
+            _mm_storeu_si128((__m128i *)(position + i), _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(p, scale), _mm256_load_pd(c.positionBias + i))));
+            __m256d v = _mm256_cvtps_pd(_mm_loadu_ps(vel + i));
+            _mm_storeu_si128((__m128i *)(velocity + i), _mm256_cvttpd_epi32(_mm256_mul_pd(v, scale)));
+            __m256d maximum = _mm256_load_pd(c.torqueMax + i);
+            __m256d t = _mm256_cvtps_pd(_mm_loadu_ps(tor + i));
+            t = _mm256_max_pd(_mm256_min_pd(t, maximum), _mm256_sub_pd(_mm256_setzero_pd(), maximum));
+            _mm_storeu_si128((__m128i *)(torque + i), _mm256_cvttpd_epi32(_mm256_mul_pd(t, _mm256_load_pd(c.torqueScale + i))));
+            i += 4;
+        }
+        _mm256_zeroupper();
+        targetScalar(c, i, count, pos, vel, tor, position, velocity, torque);
+    }
+
+    __attribute__((target("avx2"))) static void actualAVX2(MotorConversion const &c, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor)
+    {
+        int i = 0;
+        while (i + 4 <= count)
+        {
+            __m256d scale = _mm256_load_pd(c.actualPositionScale + i);
+            __m256d p = _mm256_cvtepi32_pd(_mm_loadu_si128((__m128i const *)(position + i)));
+            _mm_storeu_ps(pos + i, _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_sub_pd(p, _mm256_load_pd(c.positionBias + i)), scale)));
+            __m256d v = _mm256_cvtepi32_pd(_mm_loadu_si128((__m128i const *)(velocity + i)));
+            _mm_storeu_ps(vel + i, _mm256_cvtpd_ps(_mm256_mul_pd(v, scale)));
+            __m256d t = _mm256_cvtepi32_pd(_mm_loadu_si128((__m128i const *)(torque + i)));
+            _mm_storeu_ps(tor + i, _mm256_cvtpd_ps(_mm256_mul_pd(t, _mm256_load_pd(c.actualTorqueScale + i))));
+            i += 4;
+        }
+        _mm256_zeroupper();
+        actualScalar(c, i, count, position, velocity, torque, pos, vel, tor);
+    }
+#elif defined(__aarch64__)
+    // NEON：每次处理2个关节
+    static void targetNEON(MotorConversion const &c, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque)
+    {
+        int i = 0;
+        while (i + 2 <= count)
+        {
+            float64x2_t scale = vld1q_f64(c.positionScale + i);
+            float64x2_t p = vcvt_f64_f32(vld1_f32(pos + i));
+            p = vminq_f64(vmaxq_f64(p, vld1q_f64(c.positionMin + i)), vld1q_f64(c.positionMax + i));
+            vst1_s32(position + i, vmovn_s64(vcvtq_s64_f64(vaddq_f64(vmulq_f64(p, scale), vld1q_f64(c.positionBias + i)))));
+            float64x2_t v = vcvt_f64_f32(vld1_f32(vel + i));
+            vst1_s32(velocity + i, vmovn_s64(vcvtq_s64_f64(vmulq_f64(v, scale))));
+            float64x2_t maximum = vld1q_f64(c.torqueMax + i);
+            float64x2_t t = vcvt_f64_f32(vld1_f32(tor + i));
+            t = vmaxq_f64(vminq_f64(t, maximum), vnegq_f64(maximum));
+            vst1_s32(torque + i, vmovn_s64(vcvtq_s64_f64(vmulq_f64(t, vld1q_f64(c.torqueScale + i)))));
+            i += 2;
+        }
+        targetScalar(c, i, count, pos, vel, tor, position, velocity, torque);
+    }
+
+    static void actualNEON(MotorConversion const &c, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor)
+    {
+        int i = 0;
+        while (i + 2 <= count)
+        {
+            float64x2_t scale = vld1q_f64(c.actualPositionScale + i);
+            float64x2_t p = vcvtq_f64_s64(vmovl_s32(vld1_s32(position + i)));
+            vst1_f32(pos + i, vcvt_f32_f64(vmulq_f64(vsubq_f64(p, vld1q_f64(c.positionBias + i)), scale)));
+            float64x2_t v = vcvtq_f64_s64(vmovl_s32(vld1_s32(velocity + i)));
+            vst1_f32(vel + i, vcvt_f32_f64(vmulq_f64(v, scale)));
+            float64x2_t t = vcvtq_f64_s64(vmovl_s32(vld1_s32(torque + i)));
+            vst1_f32(tor + i, vcvt_f32_f64(vmulq_f64(t, vld1q_f64(c.actualTorqueScale + i))));
+            i += 2;
+        }
+        actualScalar(c, i, count, position, velocity, torque, pos, vel, tor);
+    }
+#endif
+
+    MotorConversion::MotorConversion()
+    {
+        count = 0;
+        positionScale = positionBias = positionMin = positionMax = nullptr;
+        torqueScale = torqueMax = nullptr;
+        actualPositionScale = actualTorqueScale = nullptr;
+        pos = vel = tor = nullptr;
+        position = velocity = torque = nullptr;
+        select("");
+    }
+
+    // 分配count个关节的系数与暂存数组，长度补齐到4的倍数，各数组按缓存行对齐
+    int MotorConversion::init(int const count)
+    {
+        this->count = count;
+        int padded = (count + 3) / 4 * 4;
+        double **coefficients[] = {&positionScale, &positionBias, &positionMin, &positionMax, &torqueScale, &torqueMax, &actualPositionScale, &actualTorqueScale};
+        int i = 0;
+        while (i < 8)
+        {
+            *coefficients[i] = (double *)Arena::instance().allocate(padded * sizeof(double));
+            if (*coefficients[i] == nullptr)
+            {
+                return -1;
+            }
+            i++;
+        }
+        float **floats[] = {&pos, &vel, &tor};
+        int **ints[] = {&position, &velocity, &torque};
+        i = 0;
+        while (i < 3)
+        {
+            *floats[i] = (float *)Arena::instance().allocate(padded * sizeof(float));
+            *ints[i] = (int *)Arena::instance().allocate(padded * sizeof(int));
+            if (*floats[i] == nullptr || *ints[i] == nullptr)
+            {
+                return -1;
+            }
+            i++;
+        }
+        printf("motor conversion of %d joints uses %s kernel\n", count, kernel);
+        return 0;
+    }
+
+    // 由电机参数计算第i个关节的系数，参数（如计数偏差）变化后需重新调用
+    void MotorConversion::update(int const i, MotorParameters const &parameters)
+    {
+        if (i < 0 || i >= count)
+        {
+            return;
+        }
+        positionScale[i] = parameters.polarity * parameters.gearRatioPosVel * parameters.encoderResolution / 2.0 / Pi;
+        positionBias[i] = parameters.countBias;
+        positionMin[i] = parameters.minimumPosition;
+        positionMax[i] = parameters.maximumPosition;
+        torqueScale[i] = parameters.polarity * 1000.0 / parameters.torqueConstant / parameters.gearRatioTor / parameters.ratedCurrent;
+        torqueMax[i] = parameters.maximumTorque;
+        actualPositionScale[i] = 2.0 * Pi * parameters.polarity / parameters.encoderResolution / parameters.gearRatioPosVel;
+        actualTorqueScale[i] = parameters.polarity / 1000.0 * parameters.ratedCurrent * parameters.torqueConstant * parameters.gearRatioTor;
+    }
+
+    // 选择换算内核："scalar"、"sse2"、"avx2"或"neon"，为空时选择当前CPU支持的最快实现；不支持时返回-1
+    int MotorConversion::select(char const *kernel)
+    {
+        bool best = kernel == nullptr || kernel[0] == '\0';
+        if (best || strcmp(kernel, "scalar") == 0)
+        {
+            this->kernel = "scalar";
+            targetKernel = targetScalar;
+            actualKernel = actualScalar;
+            if (!best)
+            {
+                return 0;
+            }
+        }
+#if defined(__x86_64__)
+        if (best || strcmp(kernel, "sse2") == 0)
+        {
+            this->kernel = "sse2";
+            targetKernel = targetSSE2;
+            actualKernel = actualSSE2;
+            if (!best)
+            {
+                return 0;
+            }
+        }
+        __builtin_cpu_init();
+        if ((best || strcmp(kernel, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+        {
+            this->kernel = "avx2";
+            targetKernel = targetAVX2;
+            actualKernel = actualAVX2;
+            return 0;
+        }
+#elif defined(__aarch64__)
+        if (best || strcmp(kernel, "neon") == 0)
+        {
+            this->kernel = "neon";
+            targetKernel = targetNEON;
+            actualKernel = actualNEON;
+            return 0;
+        }
+#endif
+        return best ? 0 : -1;
+    }
+
+    // 目标值换算：位置限幅后换算为编码器计数并加上计数偏差，速度换算为计数每秒，力矩限幅后换算为额定电流千分比
+    void MotorConversion::targets(int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque) const
+    {
+        targetKernel(*this, count, pos, vel, tor, position, velocity, torque);
+    }
+
+    // 实际值换算，为targets()的逆过程（不含限幅）
+    void MotorConversion::actuals(int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor) const
+    {
+        actualKernel(*this, count, position, velocity, torque, pos, vel, tor);
+    }
+}
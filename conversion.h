@@ -0,0 +1,49 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+#pragma once
+
+#include "common.h"
+
+namespace DriverSDK
+{
+    class MotorConversion;
+    typedef void (*TargetKernel)(MotorConversion const &conversion, int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque);
+    typedef void (*ActualKernel)(MotorConversion const &conversion, int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor);
+
+    // 电机单位换算：参数加载时为每个关节预先算好系数，按结构数组（SoA）存放，
+    // 换算时对全部关节做向量化的限幅、缩放与取整，x86_64上运行时在SSE2/AVX2间选择，aarch64上使用NEON
+    class MotorConversion
+    {
+    public:
+        int count;
+        double *positionScale, *positionBias, *positionMin, *positionMax; // 目标位置/速度：弧度 -> 编码器计数
+        double *torqueScale, *torqueMax;                                  // 目标力矩：牛米 -> 额定电流千分比
+        double *actualPositionScale, *actualTorqueScale;                  // 实际值：计数 -> 弧度，千分比 -> 牛米
+        float *pos, *vel, *tor;                                           // 结构数组形式的暂存，供AoS接口在换算前后转存
+        int *position, *velocity, *torque;
+        char const *kernel;
+        TargetKernel targetKernel;
+        ActualKernel actualKernel;
+        MotorConversion();
+        int init(int const count);
+        void update(int const i, MotorParameters const &parameters);
+        int select(char const *kernel);
+        void targets(int const count, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque) const;
+        void actuals(int const count, int const *position, int const *velocity, int const *torque, float *pos, float *vel, float *tor) const;
+    };
+}
@@ -0,0 +1,468 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+// 交换缓冲与域内存之间复制路径、单位换算与SDO队列的基准测试，不需要EtherCAT主站
+// 用法：driver_bench [slaves] [rxBytes] [txBytes] [period(ns)] [cycles] [cpu] [joints]
+
+#include "common.h"
+#include "conversion.h"
+#include "loong_driver_sdk.h"
+#include "ptr_que.h"
+#include "ptr_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    // 复制路径
+    enum Mode
+    {
+        WHOLE, // 整个域内存复制两次（未设置交换区间）
+        RANGES, // 每周期复制全部RxPDO/TxPDO区间
+        DIRTY, // RxPDO仅复制脏区间，TxPDO复制全部区间
+        NONE // 不复制，即零拷贝的理论下限
+    };
+
+    char const *modeNames[] = {"whole", "ranges", "dirty", "none"};
+
+    struct Layout
+    {
+        int slaves, rxBytes, txBytes, domainSize, period, cycles, cpu;
+    };
+
+    struct Stat
+    {
+        std::vector<long> samples;
+        void print(char const *name)
+        {
+            if (samples.size() == 0)
+            {
+                return;
+            }
+            std::sort(samples.begin(), samples.end());
+            double sum = 0, squares = 0;
+            int i = 0;
+            while (i < samples.size())
+            {
+                sum += samples[i];
+                squares += (double)samples[i] * samples[i];
+                i++;
+            }
+            double mean = sum / samples.size();
+            printf("\t%-8s mean %9.1f, std %9.1f, min %7ld, p50 %7ld, p99 %7ld, max %7ld ns\n", name, mean, sqrt(std::max(squares / samples.size() - mean * mean, 0.0)),
+                   samples.front(), samples[samples.size() / 2], samples[samples.size() * 99 / 100], samples.back());
+        }
+    };
+
+    long now()
+    {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return TIMESPEC2NS(time);
+    }
+
+    struct Bench
+    {
+        Layout layout;
+        Mode mode;
+        unsigned char *domainPtr;
+        DriverSDK::SwapList *rxSwap, *txSwap;
+        std::atomic<bool> running;
+        Stat wakeup, copy;
+    };
+
+    // 模拟应用线程：每个周期改写一个从站的目标值并提交，同时读取最新的反馈
+    void *application(void *arg)
+    {
+        Bench *bench = (Bench *)arg;
+        Layout const &layout = bench->layout;
+        unsigned char sequence = 0;
+        int slave = 0;
+        timespec wakeupTime;
+        clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
+        while (bench->running.load())
+        {
+            bench->txSwap->fetch();
+            int offset = slave * (layout.rxBytes + layout.txBytes);
+            bench->rxSwap->mark(bench->rxSwap->mask(offset));
+            memcpy(bench->rxSwap->writer() + offset, bench->txSwap->reader() + offset + layout.rxBytes, std::min(layout.rxBytes, layout.txBytes));
+            bench->rxSwap->writer()[offset] ^= ++sequence;
+            bench->rxSwap->commit();
+            slave = (slave + 1) % layout.slaves;
+            wakeupTime.tv_nsec += layout.period;
+            while (wakeupTime.tv_nsec >= NSEC_PER_SEC)
+            {
+                wakeupTime.tv_nsec -= NSEC_PER_SEC;
+                wakeupTime.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeupTime, nullptr);
+        }
+        return nullptr;
+    }
+
+    // 模拟rxtx线程：按周期唤醒，执行所选路径的域内存复制，并记录唤醒抖动与复制耗时
+    void *rxtx(void *arg)
+    {
+        Bench *bench = (Bench *)arg;
+        Layout const &layout = bench->layout;
+        if (layout.cpu >= 0)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(layout.cpu, &cpuSet);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+        }
+        sched_param param;
+        param.sched_priority = 49;
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        int count = 0;
+        timespec wakeupTime;
+        clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
+        while (count < layout.cycles)
+        {
+            wakeupTime.tv_nsec += layout.period;
+            while (wakeupTime.tv_nsec >= NSEC_PER_SEC)
+            {
+                wakeupTime.tv_nsec -= NSEC_PER_SEC;
+                wakeupTime.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeupTime, nullptr);
+            long wakeup = now();
+            // 模拟主站在接收时改写TxPDO
+            int i = 0;
+            while (i < layout.slaves)
+            {
+                bench->domainPtr[i * (layout.rxBytes + layout.txBytes) + layout.rxBytes] = count;
+                i++;
+            }
+            long begin = now();
+            if (bench->mode != NONE)
+            {
+                bench->txSwap->copyFrom(bench->domainPtr, layout.domainSize);
+                bench->rxSwap->copyTo(bench->domainPtr, layout.domainSize, bench->mode != DIRTY || count % 1000 == 0);
+            }
+            long end = now();
+            bench->wakeup.samples.push_back(wakeup - (TIMESPEC2NS(wakeupTime)));
+            bench->copy.samples.push_back(end - begin);
+            count++;
+        }
+        bench->running.store(false);
+        return nullptr;
+    }
+
+    void run(Layout const &layout, Mode const mode)
+    {
+        Bench bench;
+        bench.layout = layout;
+        bench.mode = mode;
+        bench.domainPtr = (unsigned char *)calloc(layout.domainSize, 1);
+        bench.rxSwap = new DriverSDK::SwapList(layout.domainSize);
+        bench.txSwap = new DriverSDK::SwapList(layout.domainSize);
+        if (mode != WHOLE)
+        {
+            int i = 0;
+            while (i < layout.slaves)
+            {
+                bench.rxSwap->addRange(i * (layout.rxBytes + layout.txBytes), layout.rxBytes);
+                bench.txSwap->addRange(i * (layout.rxBytes + layout.txBytes) + layout.rxBytes, layout.txBytes);
+                i++;
+            }
+        }
+        bench.wakeup.samples.reserve(layout.cycles);
+        bench.copy.samples.reserve(layout.cycles);
+        bench.running.store(true);
+        pthread_t app, bus;
+        pthread_create(&bus, nullptr, rxtx, &bench);
+        pthread_create(&app, nullptr, application, &bench);
+        pthread_join(bus, nullptr);
+        pthread_join(app, nullptr);
+        printf("%s:\n", modeNames[mode]);
+        bench.copy.print("copy");
+        bench.wakeup.print("wakeup");
+        delete bench.rxSwap;
+        delete bench.txSwap;
+        free(bench.domainPtr);
+    }
+
+    // 原setMotorTarget/getMotorActual中逐关节的换算链，作为对照
+    void legacy(int const joints, DriverSDK::MotorParameters const *parameters, float const *pos, float const *vel, float const *tor, int *position, int *velocity, int *torque, float *actual)
+    {
+        int i = 0;
+        while (i < joints)
+        {
+            float p = pos[i];
+            if (p < parameters[i].minimumPosition)
+            {
+                p = parameters[i].minimumPosition;
+            }
+            else if (p > parameters[i].maximumPosition)
+            {
+                p = parameters[i].maximumPosition;
+            }
+            position[i] = (float)(parameters[i].polarity * p * parameters[i].gearRatioPosVel * parameters[i].encoderResolution / 2.0 / DriverSDK::Pi + parameters[i].countBias);
+            velocity[i] = (float)(parameters[i].polarity * vel[i] * parameters[i].gearRatioPosVel * parameters[i].encoderResolution / 2.0 / DriverSDK::Pi);
+            float t = tor[i];
+            if (t > parameters[i].maximumTorque)
+            {
+                t = parameters[i].maximumTorque;
+            }
+            else if (t < -parameters[i].maximumTorque)
+            {
+                t = -parameters[i].maximumTorque;
+            }
+            torque[i] = (float)(parameters[i].polarity * 1000.0 * t / parameters[i].torqueConstant / parameters[i].gearRatioTor / parameters[i].ratedCurrent);
+            actual[i] = 2.0 * DriverSDK::Pi * parameters[i].polarity * (position[i] - parameters[i].countBias) / parameters[i].encoderResolution / parameters[i].gearRatioPosVel;
+            actual[joints + i] = 2.0 * DriverSDK::Pi * parameters[i].polarity * velocity[i] / parameters[i].encoderResolution / parameters[i].gearRatioPosVel;
+            actual[2 * joints + i] = parameters[i].polarity * torque[i] / 1000.0 * parameters[i].ratedCurrent * parameters[i].torqueConstant * parameters[i].gearRatioTor;
+            i++;
+        }
+    }
+
+    // 单位换算基准：每次调用换算全部关节的目标值与实际值，比较各内核与原换算链的耗时，并检查各内核与标量内核结果一致
+    void conversion(int const joints, int const iterations)
+    {
+        DriverSDK::MotorParameters *parameters = new DriverSDK::MotorParameters[joints];
+        DriverSDK::MotorConversion conversion;
+        conversion.init(joints);
+        std::vector<float> pos(joints), vel(joints), tor(joints), actual(3 * joints), reference(3 * joints);
+        std::vector<int> position(joints), velocity(joints), torque(joints), expected(3 * joints);
+        int i = 0;
+        while (i < joints)
+        {
+            parameters[i].polarity = i % 2 == 0 ? 1.0 : -1.0;
+            parameters[i].countBias = 1000 * i;
+            parameters[i].encoderResolution = 131072;
+            parameters[i].gearRatioPosVel = 10 + i;
+            parameters[i].gearRatioTor = 10 + i;
+            parameters[i].ratedCurrent = 5.0 + 0.1 * i;
+            parameters[i].torqueConstant = 0.1;
+            parameters[i].maximumTorque = 50.0;
+            parameters[i].minimumPosition = -2.0;
+            parameters[i].maximumPosition = 2.0;
+            conversion.update(i, parameters[i]);
+            pos[i] = 0.1 * i - 1.7;
+            vel[i] = 0.5 * i - 3.0;
+            tor[i] = 4.0 * i - 60.0;
+            i++;
+        }
+        printf("conversion of %d joints, %d iterations:\n", joints, iterations);
+        long begin = now();
+        i = 0;
+        while (i < iterations)
+        {
+            legacy(joints, parameters, pos.data(), vel.data(), tor.data(), position.data(), velocity.data(), torque.data(), actual.data());
+            i++;
+        }
+        printf("\t%-8s %8.1f ns per call\n", "legacy", (double)(now() - begin) / iterations);
+        char const *kernels[] = {"scalar", "sse2", "avx2", "neon"};
+        int k = 0;
+        while (k < 4)
+        {
+            if (conversion.select(kernels[k]) != 0)
+            {
+                k++;
+                continue;
+            }
+            begin = now();
+            i = 0;
+            while (i < iterations)
+            {
+                conversion.targets(joints, pos.data(), vel.data(), tor.data(), position.data(), velocity.data(), torque.data());
+                conversion.actuals(joints, position.data(), velocity.data(), torque.data(), actual.data(), actual.data() + joints, actual.data() + 2 * joints);
+                i++;
+            }
+            long elapsed = now() - begin;
+            int mismatches = 0;
+            i = 0;
+            while (i < joints)
+            {
+                if (k == 0)
+                {
+                    expected[i] = position[i];
+                    expected[joints + i] = velocity[i];
+                    expected[2 * joints + i] = torque[i];
+                }
+                mismatches += position[i] != expected[i];
+                mismatches += velocity[i] != expected[joints + i];
+                mismatches += torque[i] != expected[2 * joints + i];
+                i++;
+            }
+            i = 0;
+            while (i < 3 * joints)
+            {
+                if (k == 0)
+                {
+                    reference[i] = actual[i];
+                }
+                mismatches += actual[i] != reference[i];
+                i++;
+            }
+            printf("\t%-8s %8.1f ns per call, %d mismatches against scalar\n", kernels[k], (double)elapsed / iterations, mismatches);
+            k++;
+        }
+        delete[] parameters;
+    }
+
+    // SDO消息来源：原实现每次请求new一条消息，取回响应后delete
+    struct HeapSource
+    {
+        DriverSDK::SDOMsg *get()
+        {
+            return new DriverSDK::SDOMsg();
+        }
+        void put(DriverSDK::SDOMsg *msg)
+        {
+            delete msg;
+        }
+    };
+
+    // SDO消息来源：预分配的对象池
+    struct PoolSource
+    {
+        PtrPool<DriverSDK::SDOMsg> *pool;
+        DriverSDK::SDOMsg *get()
+        {
+            return pool->get();
+        }
+        void put(DriverSDK::SDOMsg *msg)
+        {
+            pool->put(msg);
+        }
+    };
+
+    template <typename Queue>
+    struct Relay
+    {
+        Queue *requests, *responses;
+        std::atomic<bool> running;
+    };
+
+    // 模拟实时线程：轮询请求队列，把取到的消息原样放入响应队列
+    template <typename Queue>
+    void *relay(void *arg)
+    {
+        Relay<Queue> *bench = (Relay<Queue> *)arg;
+        while (bench->running.load(std::memory_order_relaxed))
+        {
+            DriverSDK::SDOMsg *msg = bench->requests->get_nonblocking();
+            if (msg != nullptr)
+            {
+                bench->responses->put(msg);
+            }
+            else
+            {
+                sched_yield();
+            }
+        }
+        return nullptr;
+    }
+
+    // SDO队列基准：同一线程内完成一次请求与取回的耗时，以及经另一线程转发的往返延迟
+    template <typename Queue, typename Source>
+    void queue(char const *name, Queue *requests, Queue *responses, Source *source, int const iterations)
+    {
+        printf("%s, %d requests:\n", name, iterations);
+        long begin = now();
+        int i = 0;
+        while (i < iterations)
+        {
+            requests->put(source->get());
+            responses->put(requests->get_nonblocking());
+            source->put(responses->get_nonblocking());
+            i++;
+        }
+        printf("\t%-8s %8.1f ns per request\n", "local", (double)(now() - begin) / iterations);
+        Relay<Queue> bench;
+        bench.requests = requests;
+        bench.responses = responses;
+        bench.running.store(true);
+        pthread_t pth;
+        if (pthread_create(&pth, nullptr, relay<Queue>, &bench) != 0)
+        {
+            printf("creating relay thread failed\n");
+            return;
+        }
+        Stat roundTrip;
+        roundTrip.samples.reserve(iterations / 10);
+        i = 0;
+        while (i < iterations / 10)
+        {
+            long start = now();
+            requests->put(source->get());
+            DriverSDK::SDOMsg *msg = nullptr;
+            while ((msg = responses->get_nonblocking()) == nullptr)
+            {
+                sched_yield();
+            }
+            source->put(msg);
+            roundTrip.samples.push_back(now() - start);
+            i++;
+        }
+        bench.running.store(false);
+        pthread_join(pth, nullptr);
+        roundTrip.print("relay");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Layout layout;
+    layout.slaves = argc > 1 ? atoi(argv[1]) : 12;
+    layout.rxBytes = argc > 2 ? atoi(argv[2]) : 19;
+    layout.txBytes = argc > 3 ? atoi(argv[3]) : 24;
+    layout.period = argc > 4 ? atoi(argv[4]) : 1000000;
+    layout.cycles = argc > 5 ? atoi(argv[5]) : 5000;
+    layout.cpu = argc > 6 ? atoi(argv[6]) : -1;
+    int joints = argc > 7 ? atoi(argv[7]) : 31;
+    layout.domainSize = layout.slaves * (layout.rxBytes + layout.txBytes);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        printf("mlockall failed, results may include page faults\n");
+    }
+    DriverSDK::Arena::instance().init(ARENA_SIZE);
+    printf("%d slaves, rx %d B, tx %d B, domain %d B, period %d ns, %d cycles\n", layout.slaves, layout.rxBytes, layout.txBytes, layout.domainSize, layout.period, layout.cycles);
+    int mode = WHOLE;
+    while (mode <= NONE)
+    {
+        run(layout, (Mode)mode);
+        mode++;
+    }
+    conversion(joints, 100000);
+    PtrQue<DriverSDK::SDOMsg> *queRequests = new PtrQue<DriverSDK::SDOMsg>(), *queResponses = new PtrQue<DriverSDK::SDOMsg>();
+    HeapSource heap;
+    queue("PtrQue + new", queRequests, queResponses, &heap, 100000);
+    PtrRing<DriverSDK::SDOMsg> *ringRequests = new PtrRing<DriverSDK::SDOMsg>(), *ringResponses = new PtrRing<DriverSDK::SDOMsg>();
+    PoolSource pool;
+    pool.pool = new PtrPool<DriverSDK::SDOMsg>();
+    pool.pool->init(64);
+    queue("PtrRing + PtrPool", ringRequests, ringResponses, &pool, 100000);
+    delete queRequests;
+    delete queResponses;
+    delete ringRequests;
+    delete ringResponses;
+    delete pool.pool;
+    return 0;
+}
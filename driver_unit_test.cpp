@@ -0,0 +1,295 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+// 交换列表、无锁队列与对象池的行为测试，不需要EtherCAT主站；全部通过时返回0
+// 用法：driver_unit_test [commits]
+
+#include "common.h"
+#include "ptr_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+#define CHECK(condition)                                                   \
+    do                                                                     \
+    {                                                                      \
+        if (!(condition))                                                  \
+        {                                                                  \
+            printf("\t%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+    // 写端在一个区间内写入字节并标记脏位
+    void write(DriverSDK::SwapList *swap, int const offset, unsigned char const value)
+    {
+        swap->mark(swap->mask(offset));
+        swap->writer()[offset] = value;
+    }
+
+    // 提交、覆盖与取走：未被取走就被覆盖的提交，其脏区间须并入下一次提交，copyTo(full=false)不丢改动
+    void swapDirty()
+    {
+        printf("swap dirty\n");
+        DriverSDK::SwapList *swap = new DriverSDK::SwapList(16);
+        swap->addRange(0, 4);
+        swap->addRange(8, 4);
+        CHECK(swap->ranges.size() == 2);
+        CHECK(swap->mask(1) == 1ULL);
+        CHECK(swap->mask(9) == 2ULL);
+        CHECK(swap->mask(5) == ~0ULL);
+        unsigned char domain[16];
+        memset(domain, 0, sizeof(domain));
+        CHECK(!swap->fetch());
+        // 两次提交之间读端未取走，第一次提交的区间0须随第二次提交一起送达
+        write(swap, 0, 0x11);
+        swap->commit();
+        write(swap, 8, 0x22);
+        swap->commit();
+        swap->copyTo(domain, sizeof(domain), false);
+        CHECK(domain[0] == 0x11);
+        CHECK(domain[8] == 0x22);
+        CHECK((swap->reader()[0] == 0x11) && (swap->reader()[8] == 0x22));
+        // 同一区间被连续改写时以最后一次提交为准
+        write(swap, 0, 0x33);
+        swap->commit();
+        write(swap, 0, 0x44);
+        swap->commit();
+        swap->copyTo(domain, sizeof(domain), false);
+        CHECK(domain[0] == 0x44);
+        CHECK(domain[8] == 0x22);
+        // 没有新提交时不复制，域内存中其他线程写入的内容保持不变
+        domain[0] = 0x55;
+        swap->copyTo(domain, sizeof(domain), false);
+        CHECK(domain[0] == 0x55);
+        // full为真时即使没有新提交也复制全部区间，区间外的字节不被覆盖
+        domain[4] = 0x66;
+        swap->copyTo(domain, sizeof(domain), true);
+        CHECK(domain[0] == 0x44);
+        CHECK(domain[4] == 0x66);
+        // 被取走后再提交，新节点中只需带上新改动的区间，未改动的区间内容由carry保留
+        write(swap, 8, 0x77);
+        swap->commit();
+        CHECK(swap->fetch());
+        CHECK((swap->nodes[swap->readIndex]->dirty & 2ULL) != 0);
+        CHECK(swap->reader()[0] == 0x44);
+        CHECK(swap->reader()[8] == 0x77);
+        CHECK(!swap->fetch());
+        delete swap;
+    }
+
+    // 帧元数据随数据一起提交，读端取到的元数据与数据属于同一次提交
+    void swapFrame()
+    {
+        printf("swap frame\n");
+        DriverSDK::SwapList *swap = new DriverSDK::SwapList(8);
+        unsigned char domain[8];
+        DriverSDK::FrameInfo frame;
+        memset(&frame, 0, sizeof(DriverSDK::FrameInfo));
+        int i = 1;
+        while (i <= 3)
+        {
+            memset(domain, i, sizeof(domain));
+            frame.cycle = i;
+            frame.wcState = i == 2 ? 1 : 2;
+            swap->copyFrom(domain, sizeof(domain), &frame);
+            i++;
+        }
+        CHECK(swap->fetch());
+        CHECK(swap->frame().cycle == 3);
+        CHECK(swap->frame().wcState == 2);
+        CHECK(swap->reader()[0] == 3 && swap->reader()[7] == 3);
+        delete swap;
+    }
+
+    struct Handoff
+    {
+        DriverSDK::SwapList *swap;
+        int size;
+        unsigned long commits;
+    };
+
+    // 写端：每次提交把整个节点填成同一个字节，帧周期计数与之对应；每次提交后让出CPU，使读端能在提交之间取到节点
+    void *handoffWriter(void *arg)
+    {
+        Handoff *handoff = (Handoff *)arg;
+        std::vector<unsigned char> domain(handoff->size);
+        DriverSDK::FrameInfo frame;
+        memset(&frame, 0, sizeof(DriverSDK::FrameInfo));
+        unsigned long i = 1;
+        while (i <= handoff->commits)
+        {
+            memset(domain.data(), (unsigned char)i, handoff->size);
+            frame.cycle = i;
+            handoff->swap->copyFrom(domain.data(), handoff->size, &frame);
+            sched_yield();
+            i++;
+        }
+        return nullptr;
+    }
+
+    // 三缓冲交接：读端每次取到的节点都是某一次完整的提交，不会混入其他提交的字节，且提交序号单调递增
+    void swapHandoff(unsigned long const commits)
+    {
+        printf("swap handoff, %lu commits\n", commits);
+        Handoff handoff;
+        handoff.size = 256;
+        handoff.commits = commits;
+        handoff.swap = new DriverSDK::SwapList(handoff.size);
+        pthread_t writer;
+        pthread_create(&writer, nullptr, &handoffWriter, &handoff);
+        unsigned long last = 0, fetched = 0;
+        int torn = 0, backwards = 0;
+        while (last < commits)
+        {
+            if (!handoff.swap->fetch())
+            {
+                sched_yield();
+                continue;
+            }
+            fetched++;
+            unsigned long cycle = handoff.swap->frame().cycle;
+            unsigned char const *memPtr = handoff.swap->reader();
+            int i = 0;
+            while (i < handoff.size)
+            {
+                if (memPtr[i] != (unsigned char)cycle)
+                {
+                    torn++;
+                    break;
+                }
+                i++;
+            }
+            if (cycle <= last || handoff.swap->nodes[handoff.swap->readIndex]->sequence != cycle)
+            {
+                backwards++;
+            }
+            last = cycle;
+        }
+        pthread_join(writer, nullptr);
+        printf("\tfetched %lu, torn %d, out of order %d\n", fetched, torn, backwards);
+        CHECK(torn == 0);
+        CHECK(backwards == 0);
+        CHECK(last == commits);
+        delete handoff.swap;
+    }
+
+    // 队列满时put()返回-1，空时get_nonblocking()返回nullptr，先进先出，回绕后仍保持顺序
+    void ringFullEmpty()
+    {
+        printf("ring full/empty\n");
+        PtrRing<int, 8> *ring = new PtrRing<int, 8>();
+        int values[9];
+        CHECK(ring->get_nonblocking() == nullptr);
+        CHECK(ring->size() == 0);
+        int i = 0;
+        while (i < 8)
+        {
+            values[i] = i;
+            CHECK(ring->put(&values[i]) == 0);
+            i++;
+        }
+        CHECK(ring->size() == 8);
+        CHECK(ring->put(&values[8]) == -1);
+        i = 0;
+        while (i < 8)
+        {
+            CHECK(ring->get_nonblocking() == &values[i]);
+            i++;
+        }
+        CHECK(ring->get_nonblocking() == nullptr);
+        // 回绕
+        int round = 0;
+        while (round < 3)
+        {
+            i = 0;
+            while (i < 5)
+            {
+                CHECK(ring->put(&values[i]) == 0);
+                i++;
+            }
+            i = 0;
+            while (i < 5)
+            {
+                CHECK(ring->get_nonblocking() == &values[i]);
+                i++;
+            }
+            round++;
+        }
+        CHECK(ring->size() == 0);
+        delete ring;
+    }
+
+    // 对象池用尽时get()返回nullptr，归还后可再次借出，不属于本池的对象不被收下
+    void poolExhaustion()
+    {
+        printf("pool exhaustion\n");
+        PtrPool<DriverSDK::SDOMsg> *pool = new PtrPool<DriverSDK::SDOMsg>();
+        CHECK(pool->init(0) == -1);
+        CHECK(pool->init(4) == 0);
+        CHECK(pool->init(4) == -1);
+        CHECK(pool->available() == 4);
+        DriverSDK::SDOMsg *msgs[4];
+        int i = 0;
+        while (i < 4)
+        {
+            msgs[i] = pool->get();
+            CHECK(msgs[i] != nullptr);
+            CHECK(pool->owns(msgs[i]));
+            i++;
+        }
+        CHECK(pool->get() == nullptr);
+        CHECK(pool->available() == 0);
+        DriverSDK::SDOMsg stranger;
+        pool->put(&stranger);
+        CHECK(pool->available() == 0);
+        CHECK(pool->get() == nullptr);
+        pool->put(msgs[2]);
+        CHECK(pool->available() == 1);
+        CHECK(pool->get() == msgs[2]);
+        CHECK(pool->get() == nullptr);
+        i = 0;
+        while (i < 4)
+        {
+            pool->put(msgs[i]);
+            i++;
+        }
+        CHECK(pool->available() == 4);
+        delete pool;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long commits = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    DriverSDK::Arena::instance().init(ARENA_SIZE);
+    swapDirty();
+    swapFrame();
+    swapHandoff(commits);
+    ringFullEmpty();
+    poolExhaustion();
+    printf("%d checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -20,6 +20,7 @@
 #include "ecat.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/ioctl.h>
 #include <atomic>
 #include <sstream>
@@ -49,14 +50,41 @@ namespace DriverSDK
     extern unsigned short processor;
     extern std::vector<unsigned short> maxCurrent;
     extern std::atomic<bool> ecatStalled;
+    extern std::atomic<long> temperaturePeriod;
+    extern std::atomic<long> sdoSlack;
+    extern std::function<void(int const, unsigned int const)> overrunCallback;
 
     extern std::vector<RS485> *rs485sPtr;
 
     WrapperPair<HandRxData, HandTxData, EffectorParameters> hands[2];
+    cpu_set_t rxtxCPUs;    // 已启动主站的实时线程所在CPU
 
     ECAT::ECAT(int const order)
     {
         this->order = order;
+        // SDO消息在构造时按关节数一次性分配，请求按优先级经无锁队列交给SDO线程，结果按票号写入完成槽或通过回调返回
+        int i = 0;
+        while (i < SDO_LANES)
+        {
+            sdoRequestQueues[i] = new PtrRing<SDOMsg>();
+            i++;
+        }
+        sdoTable = new SDOTable();
+        sdoPool = new PtrPool<SDOMsg>();
+        int poolSize = 8 * dofAll;
+        if (poolSize < 64)
+        {
+            poolSize = 64;
+        }
+        else if (poolSize > MAX_RING_SIZE)
+        {
+            poolSize = MAX_RING_SIZE;
+        }
+        sdoPool->init(poolSize);
+        sdoCaches.resize(dofAll);
+        sdoSlaveStats = new SDOStats[dofAll > 0 ? dofAll : 1];
+        sdoObjectStats = new SDOStats[SDO_STAT_OBJECTS];
+        cycleStats = new CycleStats();
         alias2type = ecatAlias2type[order];
         if (alias2type.size() == 0)
         {
@@ -71,6 +99,53 @@ namespace DriverSDK
         }
         period = configXML->period("ECAT", order);
         dc = configXML->dc("ECAT", order);
+        refresh = configXML->refresh("ECAT", order);
+        if (refresh < 1)
+        {
+            refresh = 1;
+        }
+        std::string timingString = configXML->timing("ECAT", order);
+        if (timingString == "sleep")
+        {
+            timing = TIMING_SLEEP;
+        }
+        else if (timingString == "spin")
+        {
+            timing = TIMING_SPIN;
+        }
+        else
+        {
+            if (timingString != "hybrid")
+            {
+                printf("ecats[%d] timing should be sleep, hybrid or spin, using hybrid\n", order);
+            }
+            timing = TIMING_HYBRID;
+        }
+        spin = configXML->spin("ECAT", order);
+        if (spin < 0 || spin > period / 2)
+        {
+            printf("ecats[%d] spin should be within [0, %ld], using 0\n", order, period / 2);
+            spin = 0;
+        }
+        std::string overrunString = configXML->overrun("ECAT", order);
+        if (overrunString == "skip")
+        {
+            overrun = OVERRUN_SKIP;
+        }
+        else if (overrunString == "rephase")
+        {
+            overrun = OVERRUN_REPHASE;
+        }
+        else
+        {
+            if (overrunString != "catchup")
+            {
+                printf("ecats[%d] overrun should be catchup, skip or rephase, using catchup\n", order);
+            }
+            overrun = OVERRUN_CATCHUP;
+        }
+        overrunLimit = configXML->overrunLimit("ECAT", order);
+        exclusive = configXML->exclusive("ECAT", order);
         alias2domain = ecatAlias2domain[order];
         domainDivision = ecatDomainDivision[order];
         domains = nullptr;
@@ -82,6 +157,7 @@ namespace DriverSDK
         master = nullptr;
         fd = -1;
         pth = 0;
+        sdoPth = 0;
         while (init() < 0)
         {
             clean();
@@ -118,6 +194,10 @@ namespace DriverSDK
             txPDOSwaps[i] = nullptr;
             i++;
         }
+        rxPDORanges.clear();
+        rxPDORanges.resize(domainDivision.size());
+        txPDORanges.clear();
+        txPDORanges.resize(domainDivision.size());
         effectorAlias = 199;
         sensorAlias = 219;
         return 0;
@@ -506,7 +586,7 @@ namespace DriverSDK
                 printf("\tconfiguring PDOs failed\n");
                 return -1;
             }
-            unsigned int bitPosition = 0;
+            unsigned int bitPosition = 0, rxPDOBits = 0, txPDOBits = 0;
             k = 0;
             printf("\t%x, %x, %u\n", pdoEntries[k].index, pdoEntries[k].subindex, pdoEntries[k].bit_length);
             int rxPDOOffset = ecrt_slave_config_reg_pdo_entry(slaveConfig, pdoEntries[k].index, pdoEntries[k].subindex, domains[domain], &bitPosition);
@@ -515,6 +595,7 @@ namespace DriverSDK
                 printf("\tregistering RxPDO entry failed\n");
                 return -1;
             }
+            rxPDOBits += pdoEntries[k].bit_length;
             k++;
             while (k < rxPDOCount)
             {
@@ -524,6 +605,7 @@ namespace DriverSDK
                     printf("\tregistering RxPDO entry failed\n");
                     return -1;
                 }
+                rxPDOBits += pdoEntries[k].bit_length;
                 k++;
             }
             printf("\t%x, %x, %u\n", pdoEntries[k].index, pdoEntries[k].subindex, pdoEntries[k].bit_length);
@@ -533,6 +615,7 @@ namespace DriverSDK
                 printf("\tregistering TxPDO entry failed\n");
                 return -1;
             }
+            txPDOBits += pdoEntries[k].bit_length;
             k++;
             while (k < rxPDOCount + txPDOCount)
             {
@@ -542,16 +625,19 @@ namespace DriverSDK
                     printf("\tregistering TxPDO entry failed\n");
                     return -1;
                 }
+                txPDOBits += pdoEntries[k].bit_length;
                 k++;
             }
-            printf("\trxPDOOffset %d, txPDOOffset %d\n", rxPDOOffset, txPDOOffset);
+            printf("\trxPDOOffset %d, rxPDOSize %u, txPDOOffset %d, txPDOSize %u\n", rxPDOOffset, (rxPDOBits + 7) / 8, txPDOOffset, (txPDOBits + 7) / 8);
+            rxPDORanges[domain].push_back(SwapRange{rxPDOOffset, (int)(rxPDOBits + 7) / 8});
+            txPDORanges[domain].push_back(SwapRange{txPDOOffset, (int)(txPDOBits + 7) / 8});
             ec_sdo_request_t *sdoHandler = ecrt_slave_config_create_sdo_request(slaveConfig, 0x0000, 0x00, 4);
             if (sdoHandler == nullptr)
             {
                 printf("\tcreating SDO request failed\n");
                 return -1;
             }
-            ecrt_sdo_request_timeout(sdoHandler, 500);
+            ecrt_sdo_request_timeout(sdoHandler, SDO_TIMEOUT);
             if (category == "driver")
             {
                 if (drivers[alias - 1].init("ECAT", order, domain, slave, alias, type, rxPDOOffset, txPDOOffset, sdoHandler) != 0)
@@ -559,6 +645,14 @@ namespace DriverSDK
                     printf("\tdrivers[%d] init failed\n", alias - 1);
                     return -1;
                 }
+                sdoCaches[alias - 1].clear();
+                std::vector<unsigned int> keys = configXML->cacheable(deviceXML);
+                i = 0;
+                while (i < keys.size())
+                {
+                    sdoCaches[alias - 1].push_back(SDOCache{keys[i], false, 0});
+                    i++;
+                }
             }
             else if (category == "effector")
             {
@@ -656,6 +750,19 @@ namespace DriverSDK
             rxPDOSwaps[i] = new SwapList(domainSizes[i]);
             txPDOSwaps[i] = new SwapList(domainSizes[i]);
             int j = 0;
+            while (j < rxPDORanges[i].size())
+            {
+                rxPDOSwaps[i]->addRange(rxPDORanges[i][j].offset, rxPDORanges[i][j].size);
+                j++;
+            }
+            j = 0;
+            while (j < txPDORanges[i].size())
+            {
+                txPDOSwaps[i]->addRange(txPDORanges[i][j].offset, txPDORanges[i][j].size);
+                j++;
+            }
+            printf("master %d, domain %d, %ld RxPDO range(s), %ld TxPDO range(s)\n", order, i, rxPDOSwaps[i]->ranges.size(), txPDOSwaps[i]->ranges.size());
+            j = 0;
             while (j < dofAll)
             {
            
@@ -712,33 +819,7 @@ namespace DriverSDK
                     hands[j].rx->TargetSpeedMiddle = 100;
                     hands[j].rx->TargetSpeedRing = 100;
                     hands[j].rx->TargetSpeedLittle = 100;
-                    rxPDOSwaps[i]->advanceNodePtr();
-                    hands[j].rx->CurrentLimitThumb = 1000;
-                    hands[j].rx->CurrentLimitThumbBend = 1000;
-                    hands[j].rx->CurrentLimitForefinger = 1000;
-                    hands[j].rx->CurrentLimitMiddle = 1000;
-                    hands[j].rx->CurrentLimitRing = 1000;
-                    hands[j].rx->CurrentLimitLittle = 1000;
-                    hands[j].rx->TargetSpeedThumb = 100;
-                    hands[j].rx->TargetSpeedThumbBend = 100;
-                    hands[j].rx->TargetSpeedForefinger = 100;
-                    hands[j].rx->TargetSpeedMiddle = 100;
-                    hands[j].rx->TargetSpeedRing = 100;
-                    hands[j].rx->TargetSpeedLittle = 100;
-                    rxPDOSwaps[i]->advanceNodePtr();
-                    hands[j].rx->CurrentLimitThumb = 1000;
-                    hands[j].rx->CurrentLimitThumbBend = 1000;
-                    hands[j].rx->CurrentLimitForefinger = 1000;
-                    hands[j].rx->CurrentLimitMiddle = 1000;
-                    hands[j].rx->CurrentLimitRing = 1000;
-                    hands[j].rx->CurrentLimitLittle = 1000;
-                    hands[j].rx->TargetSpeedThumb = 100;
-                    hands[j].rx->TargetSpeedThumbBend = 100;
-                    hands[j].rx->TargetSpeedForefinger = 100;
-                    hands[j].rx->TargetSpeedMiddle = 100;
-                    hands[j].rx->TargetSpeedRing = 100;
-                    hands[j].rx->TargetSpeedLittle = 100;
-                    rxPDOSwaps[i]->advanceNodePtr();
+                    rxPDOSwaps[i]->commit();
                     break;
                 case -1:
                     printf("hands[%d] config failed\n", j);
@@ -789,184 +870,571 @@ namespace DriverSDK
         return 0;
     }
 
-    void *ECAT::rxtx(void *arg)
+    // 推进一条SDO请求的状态机：0设置索引，1发起读写（与0在同一周期内完成），2等待结果，3完成，-1失败（超过截止时间）；结束时返回1
+    int ECAT::sdoStep(SDOMsg *sdoMsg, long const now)
     {
-        ECAT *ecat = (ECAT *)arg;
-        int domainCount = ecat->domainDivision.size(), tryCount = 0, slavesResponding = 0, alStates = 0, workingCounters[domainCount] = {0}, wcStates[domainCount] = {0};
-        printf("ecats[%d], period %ld, dc %d, domainCount %d, domainDivisions: ", ecat->order, ecat->period, ecat->dc, domainCount);
-        int i = 0;
-        while (i < domainCount)
+        if (now > sdoMsg->deadline)
         {
-            printf("%d ", ecat->domainDivision[i]);
-            i++;
+            sdoMsg->state = -1;
         }
-        printf("\n");
-        unsigned int count = 0xffffffff;
-        SDOMsg *sdoMsg = nullptr;
-        ec_master_state_t masterState;
-        ec_domain_state_t domainStates[domainCount];
-        struct timespec currentTime, wakeupTime, step{0, 6 * ecat->period / 100};
-        while (step.tv_nsec >= NSEC_PER_SEC)
-        {
-            step.tv_nsec -= NSEC_PER_SEC;
-            step.tv_sec++;
-        }
-        clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
-        while (true)
+        if (sdoMsg->state == 0)
         {
-            if (sdoMsg == nullptr)
+            switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
             {
-                sdoMsg = ecat->sdoRequestQueue.get_nonblocking();
+            case EC_REQUEST_UNUSED:
+            case EC_REQUEST_SUCCESS:
+                ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
+                sdoMsg->state = 1;
+                break;
+            case EC_REQUEST_ERROR:
+                ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
+            case EC_REQUEST_BUSY:
+                break;
             }
-            else
+        }
+        // 设置索引后请求状态不变，同一周期内直接发起读写，每条请求少等一个周期
+        if (sdoMsg->state == 1)
+        {
+            switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
             {
-                if (tryCount > 500)
-                {
-                    sdoMsg->state = -1;
-                }
-                if (sdoMsg->state == 0)
+            case EC_REQUEST_UNUSED:
+            case EC_REQUEST_SUCCESS:
+                if (sdoMsg->operation == 0)
                 {
-                    switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
+                    // 写入的数值须在发起下载前放入请求缓冲区
+                    if (sdoMsg->bitLength == 8)
                     {
-                    case EC_REQUEST_UNUSED:
-                    case EC_REQUEST_SUCCESS:
-                        ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
-                        sdoMsg->state = 1;
-                        break;
-                    case EC_REQUEST_ERROR:
-                        ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
-                    case EC_REQUEST_BUSY:
-                        tryCount++;
-                        break;
+                        EC_WRITE_U8(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
+                    }
+                    else if (sdoMsg->bitLength == 16)
+                    {
+                        EC_WRITE_U16(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
+                    }
+                    else if (sdoMsg->bitLength == 32)
+                    {
+                        EC_WRITE_U32(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
                     }
+                    ecrt_sdo_request_write(sdoMsg->sdoHandler);
                 }
-                else if (sdoMsg->state == 1)
+                else if (sdoMsg->operation == 1)
                 {
-                    switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
+                    ecrt_sdo_request_read(sdoMsg->sdoHandler);
+                }
+                sdoMsg->state = 2;
+                break;
+            case EC_REQUEST_ERROR:
+                ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
+            case EC_REQUEST_BUSY:
+                break;
+            }
+        }
+        else if (sdoMsg->state == 2)
+        {
+            switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
+            {
+            case EC_REQUEST_UNUSED:
+            case EC_REQUEST_SUCCESS:
+                if (sdoMsg->bitLength == 8)
+                {
+                    if (sdoMsg->signed_ == 0)
                     {
-                    case EC_REQUEST_UNUSED:
-                    case EC_REQUEST_SUCCESS:
                         if (sdoMsg->operation == 0)
                         {
-                            ecrt_sdo_request_write(sdoMsg->sdoHandler);
+                            EC_WRITE_U8(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
                         }
                         else if (sdoMsg->operation == 1)
                         {
-                            ecrt_sdo_request_read(sdoMsg->sdoHandler);
+                            sdoMsg->value = EC_READ_U8(ecrt_sdo_request_data(sdoMsg->sdoHandler));
+                        }
+                    }
+                    else if (sdoMsg->signed_ == 1)
+                    {
+                        if (sdoMsg->operation == 0)
+                        {
+                            EC_WRITE_S8(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
+                        }
+                        else if (sdoMsg->operation == 1)
+                        {
+                            sdoMsg->value = EC_READ_S8(ecrt_sdo_request_data(sdoMsg->sdoHandler));
                         }
-                        sdoMsg->state = 2;
-                        break;
-                    case EC_REQUEST_ERROR:
-                        ecrt_sdo_request_index(sdoMsg->sdoHandler, sdoMsg->index, sdoMsg->subindex);
-                    case EC_REQUEST_BUSY:
-                        tryCount++;
-                        break;
                     }
                 }
-                else if (sdoMsg->state == 2)
+                else if (sdoMsg->bitLength == 16)
                 {
-                    switch (ecrt_sdo_request_state(sdoMsg->sdoHandler))
+                    if (sdoMsg->signed_ == 0)
                     {
-                    case EC_REQUEST_UNUSED:
-                    case EC_REQUEST_SUCCESS:
-                        if (sdoMsg->bitLength == 8)
+                        if (sdoMsg->operation == 0)
                         {
-                            if (sdoMsg->signed_ == 0)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_U8(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_U8(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
-                            else if (sdoMsg->signed_ == 1)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_S8(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_S8(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
+                            EC_WRITE_U16(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
                         }
-                        else if (sdoMsg->bitLength == 16)
+                        else if (sdoMsg->operation == 1)
                         {
-                            if (sdoMsg->signed_ == 0)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_U16(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_U16(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
-                            else if (sdoMsg->signed_ == 1)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_S16(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_S16(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
+                            sdoMsg->value = EC_READ_U16(ecrt_sdo_request_data(sdoMsg->sdoHandler));
                         }
-                        else if (sdoMsg->bitLength == 32)
+                    }
+                    else if (sdoMsg->signed_ == 1)
+                    {
+                        if (sdoMsg->operation == 0)
                         {
-                            if (sdoMsg->signed_ == 0)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_U32(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_U32(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
-                            else if (sdoMsg->signed_ == 1)
-                            {
-                                if (sdoMsg->operation == 0)
-                                {
-                                    EC_WRITE_S32(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
-                                }
-                                else if (sdoMsg->operation == 1)
-                                {
-                                    sdoMsg->value = EC_READ_S32(ecrt_sdo_request_data(sdoMsg->sdoHandler));
-                                }
-                            }
+                            EC_WRITE_S16(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
                         }
-                        sdoMsg->state = 3;
-                        break;
-                    case EC_REQUEST_ERROR:
+                        else if (sdoMsg->operation == 1)
+                        {
+                            sdoMsg->value = EC_READ_S16(ecrt_sdo_request_data(sdoMsg->sdoHandler));
+                        }
+                    }
+                }
+                else if (sdoMsg->bitLength == 32)
+                {
+                    if (sdoMsg->signed_ == 0)
+                    {
+                        if (sdoMsg->operation == 0)
+                        {
+                            EC_WRITE_U32(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
+                        }
+                        else if (sdoMsg->operation == 1)
+                        {
+                            sdoMsg->value = EC_READ_U32(ecrt_sdo_request_data(sdoMsg->sdoHandler));
+                        }
+                    }
+                    else if (sdoMsg->signed_ == 1)
+                    {
                         if (sdoMsg->operation == 0)
                         {
-                            ecrt_sdo_request_write(sdoMsg->sdoHandler);
+                            EC_WRITE_S32(ecrt_sdo_request_data(sdoMsg->sdoHandler), sdoMsg->value);
                         }
                         else if (sdoMsg->operation == 1)
                         {
-                            ecrt_sdo_request_read(sdoMsg->sdoHandler);
+                            sdoMsg->value = EC_READ_S32(ecrt_sdo_request_data(sdoMsg->sdoHandler));
                         }
-                    case EC_REQUEST_BUSY:
-                        tryCount++;
+                    }
+                }
+                sdoMsg->state = 3;
+                break;
+            case EC_REQUEST_ERROR:
+                sdoMsg->retries++;
+                if (sdoMsg->operation == 0)
+                {
+                    ecrt_sdo_request_write(sdoMsg->sdoHandler);
+                }
+                else if (sdoMsg->operation == 1)
+                {
+                    ecrt_sdo_request_read(sdoMsg->sdoHandler);
+                }
+            case EC_REQUEST_BUSY:
+                break;
+            }
+        }
+        return sdoMsg->state == 3 || sdoMsg->state == -1 ? 1 : 0;
+    }
+
+    // 按从站和对象记录已结束请求的延迟、重试次数与失败数；对象表满后新对象只计入从站统计
+    void ECAT::sdoRecord(SDOMsg const *sdoMsg, long const now)
+    {
+        if (sdoMsg->alias > 0 && sdoMsg->alias <= dofAll)
+        {
+            sdoSlaveStats[sdoMsg->alias - 1].record(*sdoMsg, now);
+        }
+        int key = (int)sdoMsg->index << 8 | sdoMsg->subindex;
+        int i = 0;
+        while (i < SDO_STAT_OBJECTS)
+        {
+            int current = sdoObjectStats[i].key.load(std::memory_order_relaxed);
+            if (current == key)
+            {
+                sdoObjectStats[i].record(*sdoMsg, now);
+                break;
+            }
+            if (current < 0)
+            {
+                sdoObjectStats[i].record(*sdoMsg, now);
+                sdoObjectStats[i].key.store(key, std::memory_order_release);
+                break;
+            }
+            i++;
+        }
+    }
+
+    // 结束一条应用请求：带回调的请求在本线程调用回调，否则按票号写入完成槽；随后归还消息
+    void ECAT::sdoFinish(SDOMsg *sdoMsg, long const now)
+    {
+        sdoRecord(sdoMsg, now);
+        if (sdoMsg->callback != nullptr)
+        {
+            (*sdoMsg->callback)(*sdoMsg);
+            delete sdoMsg->callback;
+            sdoMsg->callback = nullptr;
+        }
+        else
+        {
+            sdoTable->complete(*sdoMsg);
+        }
+        sdoPool->put(sdoMsg);
+    }
+
+    // 请求对应的缓存项，对象未标记为可缓存时返回nullptr
+    SDOCache *ECAT::sdoCache(SDOMsg const *sdoMsg)
+    {
+        if (sdoMsg->alias <= 0 || sdoMsg->alias > sdoCaches.size())
+        {
+            return nullptr;
+        }
+        std::vector<SDOCache> &caches = sdoCaches[sdoMsg->alias - 1];
+        unsigned int key = (unsigned int)sdoMsg->index << 8 | sdoMsg->subindex;
+        int i = 0;
+        while (i < caches.size())
+        {
+            if (caches[i].key == key)
+            {
+                return &caches[i];
+            }
+            i++;
+        }
+        return nullptr;
+    }
+
+    // 派发前检查缓存：可缓存对象的读请求命中时直接结束，不产生总线访问；写请求使该对象的缓存失效
+    bool ECAT::sdoCached(SDOMsg *sdoMsg, long const now)
+    {
+        SDOCache *cache = sdoCache(sdoMsg);
+        if (cache == nullptr)
+        {
+            return false;
+        }
+        if (sdoMsg->operation != 1)
+        {
+            cache->valid = false;
+            return false;
+        }
+        if (!cache->valid)
+        {
+            return false;
+        }
+        sdoMsg->value = cache->value;
+        sdoMsg->state = 3;
+        sdoFinish(sdoMsg, now);
+        return true;
+    }
+
+    // CiA 402状态机：由实时TxPDO中的状态字与应用设定的期望状态得到本周期的控制字，每周期最多推进一步
+    // desired: -1 故障复位，0 禁用，1 启用，2 快速停止；previous为上一周期写出的控制字
+    unsigned short ECAT::controlWord(unsigned short const statusWord, int const desired, unsigned short const previous)
+    {
+        bool fault = (statusWord & 0x4f) == 0x08;
+        switch (desired)
+        {
+        case 1:
+            if ((statusWord & 0x6f) == 0x21) // 准备开启
+            {
+                return 0x07;
+            }
+            if ((statusWord & 0x6f) == 0x23 || (statusWord & 0x6f) == 0x27) // 已开启、运行使能
+            {
+                return 0x0f;
+            }
+            if ((statusWord & 0x6f) == 0x07) // 快速停止激活：是否可直接回到运行使能取决于快速停止选项码，统一先禁止电压回到开启禁止，再走关闭、开启流程
+            {
+                return 0x00;
+            }
+            return 0x06;
+        case 2:
+            return 0x02;
+        case -1:
+            if (fault)
+            {
+                return (previous & 0x80) != 0 ? 0x06 : 0x86; // 故障复位需要bit7的上升沿
+            }
+            return 0x06;
+        default:
+            return 0x06;
+        }
+    }
+
+    // SDO线程：以普通调度策略运行，每个总线周期推进一次本主站全部在途SDO请求，与实时线程之间只经无锁队列、完成槽和原子变量交换数据。
+    // 本线程与实时线程并发调用ecrt接口是安全的：用户态库中每个ecrt_sdo_request_*调用都是对主站设备的一次独立ioctl，
+    // 内核侧（master/ioctl.c的ec_ioctl_sdo_request_*）只读写该请求对象的状态与数据缓冲，不接触域和数据报队列；
+    // 邮箱传输由主站内部的从站状态机（master/fsm_slave.c）消费请求状态并生成数据报，随ecrt_master_send发出，
+    // 请求对象本就设计为由应用上下文改写、同时由主站状态机在其自身上下文中处理，实时线程的收发不会与之竞争。
+    // ecrt_master_send/receive与域相关的调用仍只由实时线程发出，本线程不调用它们
+    void *ECAT::sdoEngine(void *arg)
+    {
+        ECAT *ecat = (ECAT *)arg;
+        stackPrefault();
+        // SDO在途表：本主站每个有SDO处理器的驱动器占一个槽位，不同从站的请求在同一周期内并行推进
+        std::vector<int> sdoSlots(dofAll, -1);
+        std::vector<SDOMsg *> sdoInFlight;
+        std::vector<SDOMsg *> sdoWaiting[SDO_LANES];
+        int i = 0;
+        while (i < SDO_LANES)
+        {
+            sdoWaiting[i].reserve(MAX_RING_SIZE);
+            i++;
+        }
+        // 温度轮询：按轮转顺序向本主站下槽位空闲的驱动器发起温度读取，消息预先分配，结果写入各关节温度缓存
+        std::vector<int> temperatureJoints;
+        i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order == ecat->order && drivers[i].sdoHandler != nullptr)
+            {
+                sdoSlots[i] = sdoInFlight.size();
+                sdoInFlight.push_back(nullptr);
+                if (drivers[i].parameters.temperatureSDO.sdoHandler != nullptr)
+                {
+                    temperatureJoints.push_back(i);
+                }
+            }
+            i++;
+        }
+        int temperatureNext = 0;
+        unsigned int count = 0, temperatureCount = count;
+        bool temperatureBusy = false;
+        SDOMsg temperatureMsg;
+        unsigned int epoch = ecat->sdoTable->epoch.load(std::memory_order_relaxed);
+        struct timespec currentTime, wakeupTime;
+        clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
+        while (true)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            long now = TIMESPEC2NS(currentTime);
+            // 实时线程发布的超时事件在此回调，用户代码不在实时线程中执行
+            unsigned int reported = ecat->cycleStats->pending.exchange(0, std::memory_order_acquire);
+            if (reported > 0 && overrunCallback)
+            {
+                overrunCallback(ecat->order, reported);
+            }
+            // 邮箱报文随实时线程的ecrt_master_send发出，上一周期余量低于阈值时本周期不发起新的读写，只查询在途请求的状态
+            bool tight = ecat->sdoTable->slack.load(std::memory_order_relaxed) < sdoSlack.load(std::memory_order_relaxed) * ecat->period / 100;
+            // 从站离开OP或掉线后，缓存的对象值不再可信
+            if (ecat->sdoTable->epoch.load(std::memory_order_relaxed) != epoch)
+            {
+                epoch = ecat->sdoTable->epoch.load(std::memory_order_relaxed);
+                i = 0;
+                while (i < ecat->sdoCaches.size())
+                {
+                    int j = 0;
+                    while (j < ecat->sdoCaches[i].size())
+                    {
+                        ecat->sdoCaches[i][j].valid = false;
+                        j++;
+                    }
+                    i++;
+                }
+            }
+            // 先推进在途请求并结束已完成的请求，腾出的槽位在下面的派发中立即复用
+            i = 0;
+            while (i < sdoInFlight.size())
+            {
+                SDOMsg *sdoMsg = sdoInFlight[i];
+                if (sdoMsg != nullptr && tight && sdoMsg->state == 0 && now <= sdoMsg->deadline)
+                {
+                    ecat->sdoTable->deferred.fetch_add(1, std::memory_order_relaxed);
+                    i++;
+                    continue;
+                }
+                if (sdoMsg == nullptr || sdoStep(sdoMsg, now) == 0)
+                {
+                    i++;
+                    continue;
+                }
+                if (sdoMsg == &temperatureMsg)
+                {
+                    int j = temperatureJoints[temperatureNext];
+                    ecat->sdoRecord(sdoMsg, now);
+                    if (sdoMsg->state < 0)
+                    {
+                        printf("requesting drivers[%d] temperature failed\n", j);
+                    }
+                    else
+                    {
+                        drivers[j].parameters.temperature.store(sdoMsg->value, std::memory_order_relaxed);
+                    }
+                    temperatureNext = (temperatureNext + 1) % temperatureJoints.size();
+                    temperatureBusy = false;
+                }
+                else
+                {
+                    SDOCache *cache = ecat->sdoCache(sdoMsg);
+                    if (cache != nullptr)
+                    {
+                        cache->valid = sdoMsg->operation == 1 && sdoMsg->state == 3;
+                        cache->value = sdoMsg->value;
+                    }
+                    ecat->sdoFinish(sdoMsg, now);
+                }
+                sdoInFlight[i] = nullptr;
+                i++;
+            }
+            // 高优先级通道先于低优先级通道派发；同一通道内先派发等待中的请求，再从请求队列取新请求，
+            // 目标从站空闲时直接派发，否则排在该通道的等待表中，同一从站同一通道的请求保持先后顺序
+            int lane = SDO_LANES - 1;
+            while (lane >= 0)
+            {
+                std::vector<SDOMsg *> &waiting = sdoWaiting[lane];
+                int kept = 0;
+                i = 0;
+                while (i < waiting.size())
+                {
+                    int slot = sdoSlots[waiting[i]->alias - 1];
+                    if (sdoInFlight[slot] == nullptr)
+                    {
+                        if (!ecat->sdoCached(waiting[i], now))
+                        {
+                            sdoInFlight[slot] = waiting[i];
+                        }
+                    }
+                    else
+                    {
+                        waiting[kept] = waiting[i];
+                        kept++;
+                    }
+                    i++;
+                }
+                waiting.resize(kept);
+                i = 0;
+                while (i < sdoInFlight.size() && waiting.size() < waiting.capacity())
+                {
+                    SDOMsg *sdoMsg = ecat->sdoRequestQueues[lane]->get_nonblocking();
+                    if (sdoMsg == nullptr)
+                    {
                         break;
                     }
+                    int slot = sdoMsg->alias > 0 && sdoMsg->alias <= dofAll ? sdoSlots[sdoMsg->alias - 1] : -1;
+                    if (slot < 0)
+                    {
+                        sdoMsg->state = -1;
+                        ecat->sdoFinish(sdoMsg, now);
+                    }
+                    else if (sdoInFlight[slot] == nullptr)
+                    {
+                        if (!ecat->sdoCached(sdoMsg, now))
+                        {
+                            sdoInFlight[slot] = sdoMsg;
+                        }
+                    }
+                    else
+                    {
+                        waiting.push_back(sdoMsg);
+                    }
+                    i++;
+                }
+                lane--;
+            }
+            long temperatureInterval = temperaturePeriod.load(std::memory_order_relaxed);
+            if (!tight && !temperatureBusy && temperatureInterval > 0 && temperatureJoints.size() > 0)
+            {
+                temperatureInterval /= ecat->period * (long)temperatureJoints.size();
+                if (temperatureInterval < 1)
+                {
+                    temperatureInterval = 1;
                 }
-                else if (sdoMsg->state == 3 || sdoMsg->state == -1)
+                if (count - temperatureCount >= temperatureInterval)
                 {
-                    ecat->sdoResponseQueue.put(sdoMsg);
-                    sdoMsg = nullptr;
-                    tryCount = 0;
+                    temperatureCount = count;
+                    int j = temperatureJoints[temperatureNext];
+                    if (sdoInFlight[sdoSlots[j]] == nullptr && drivers[j].parameters.statusWord.load(std::memory_order_relaxed) > 0)
+                    {
+                        temperatureMsg = drivers[j].parameters.temperatureSDO;
+                        temperatureMsg.state = 0;
+                        temperatureMsg.deadline = now + SDO_TIMEOUT * 1000000L;
+                        temperatureMsg.issued = now;
+                        temperatureMsg.retries = 0;
+                        sdoInFlight[sdoSlots[j]] = &temperatureMsg;
+                        temperatureBusy = true;
+                    }
+                    else
+                    {
+                        temperatureNext = (temperatureNext + 1) % temperatureJoints.size();
+                    }
+                }
+            }
+            // 刚派发的请求在本周期内直接设置索引并发起读写，上一条请求结束的从站不空等一个周期
+            i = 0;
+            while (i < sdoInFlight.size())
+            {
+                if (sdoInFlight[i] != nullptr && sdoInFlight[i]->state == 0)
+                {
+                    if (tight)
+                    {
+                        ecat->sdoTable->deferred.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        sdoStep(sdoInFlight[i], now);
+                    }
                 }
+                i++;
+            }
+            count++;
+            wakeupTime.tv_nsec += ecat->period;
+            while (wakeupTime.tv_nsec >= NSEC_PER_SEC)
+            {
+                wakeupTime.tv_nsec -= NSEC_PER_SEC;
+                wakeupTime.tv_sec++;
             }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeupTime, nullptr);
+        }
+        return nullptr;
+    }
+
+    // 自旋窗口校准：连续若干次睡眠到绝对时刻，取最大唤醒延迟再留一半余量，不超过周期的一半
+    long ECAT::spinWindow(long const period)
+    {
+        long window = 0;
+        struct timespec currentTime, wakeupTime;
+        int i = 0;
+        while (i < 100)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            long target = TIMESPEC2NS(currentTime) + period / 4;
+            wakeupTime.tv_sec = target / NSEC_PER_SEC;
+            wakeupTime.tv_nsec = target % NSEC_PER_SEC;
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeupTime, nullptr) == EINTR)
+                ;
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            if (TIMESPEC2NS(currentTime) - target > window)
+            {
+                window = TIMESPEC2NS(currentTime) - target;
+            }
+            i++;
+        }
+        window += window / 2;
+        return window > period / 2 ? period / 2 : window;
+    }
+
+    void *ECAT::rxtx(void *arg)
+    {
+        ECAT *ecat = (ECAT *)arg;
+        stackPrefault();
+        int domainCount = ecat->domainDivision.size(), slavesResponding = 0, alStates = 0, workingCounters[domainCount] = {0}, wcStates[domainCount] = {0};
+        printf("ecats[%d], period %ld, dc %d, domainCount %d, domainDivisions: ", ecat->order, ecat->period, ecat->dc, domainCount);
+        int i = 0;
+        while (i < domainCount)
+        {
+            printf("%d ", ecat->domainDivision[i]);
+            i++;
+        }
+        printf("\n");
+        unsigned int count = 0xffffffff;
+        ec_master_state_t masterState;
+        ec_domain_state_t domainStates[domainCount];
+        FrameInfo frame;
+        memset(&frame, 0, sizeof(FrameInfo));
+        std::vector<unsigned short> controlWords(dofAll, 0);
+        // 周期等待：sleep只睡眠到周期起点；hybrid睡眠到起点前spin纳秒，之后轮询时钟，spin为0时按实测唤醒延迟校准；spin全程轮询
+        long spin = ecat->spin;
+        if (ecat->timing == TIMING_HYBRID && spin == 0)
+        {
+            spin = spinWindow(ecat->period);
+        }
+        printf("ecats[%d] timing %d, spin %ld\n", ecat->order, ecat->timing, spin);
+        struct timespec currentTime, wakeupTime, spinTime;
+        clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
+        long cycleStart = TIMESPEC2NS(wakeupTime), lateness = 0, late = 0;
+        bool woken = false;
+        unsigned int overruns = 0;
+        while (true)
+        {
             if (ecat->dc)
             {
                 clock_gettime(CLOCK_MONOTONIC, &currentTime);
@@ -979,46 +1447,166 @@ namespace DriverSDK
             {
                 if (ecat->rxPDOSwaps[i] != nullptr && count % ecat->domainDivision[i] == 0)
                 {
-                    ecat->rxPDOSwaps[i]->copyTo(ecat->domainPtrs[i], ecat->domainSizes[i]);
+                    ecat->rxPDOSwaps[i]->copyTo(ecat->domainPtrs[i], ecat->domainSizes[i], count / ecat->domainDivision[i] % ecat->refresh == 0);
+                    // 控制字与模式由本线程按上一次接收到的状态字直接写入域内存，覆盖应用侧节点中的对应字段；
+                    // 未进入运行使能时目标位置跟随实际位置，使能瞬间不会跳变
+                    int j = 0;
+                    while (j < dofAll)
+                    {
+                        if (drivers[j].order != ecat->order || drivers[j].domain != i)
+                        {
+                            j++;
+                            continue;
+                        }
+                        DriverTxData const *tx = (DriverTxData const *)(ecat->domainPtrs[i] + drivers[j].tx.offset);
+                        DriverRxData *rx = (DriverRxData *)(ecat->domainPtrs[i] + drivers[j].rx.offset);
+                        controlWords[j] = controlWord(tx->StatusWord, drivers[j].desired.load(std::memory_order_relaxed), controlWords[j]);
+                        drivers[j].parameters.statusWord.store(tx->StatusWord, std::memory_order_relaxed);
+                        rx->ControlWord = controlWords[j];
+                        rx->Mode = drivers[j].parameters.mode.load(std::memory_order_relaxed);
+                        if ((tx->StatusWord & 0x6f) != 0x27)
+                        {
+                            rx->TargetPosition = tx->ActualPosition;
+                        }
+                        j++;
+                    }
                     ecrt_domain_queue(ecat->domains[i]);
                 }
                 i++;
             }
             ecrt_master_send(ecat->master);
+            // 本周期从唤醒到发送完成所用时间，余量供SDO线程决定是否发起新的邮箱读写
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            long sent = TIMESPEC2NS(currentTime);
+            ecat->sdoTable->slack.store(ecat->period - (sent - cycleStart), std::memory_order_relaxed);
             wakeupTime.tv_nsec += ecat->period;
             while (wakeupTime.tv_nsec >= NSEC_PER_SEC)
             {
                 wakeupTime.tv_nsec -= NSEC_PER_SEC;
                 wakeupTime.tv_sec++;
             }
-            bool sleep = true;
-            do
+            // 超时：唤醒时已晚于周期起点一个周期以上，或发送完成时已过下一周期起点。catchup立即进入下一周期；
+            // skip跳到下一个未开始的周期起点，周期计数同步前进，域分频与刷新的节拍不变；rephase从发送完成时刻起重新计时
+            long missed = 0;
+            if (late > 0 || sent >= TIMESPEC2NS(wakeupTime))
+            {
+                overruns++;
+                long next = TIMESPEC2NS(wakeupTime);
+                if (ecat->overrun != OVERRUN_CATCHUP)
+                {
+                    missed = late;
+                }
+                if (ecat->overrun == OVERRUN_SKIP)
+                {
+                    if (sent >= next)
+                    {
+                        missed += (sent - next) / ecat->period + 1;
+                        next += ((sent - next) / ecat->period + 1) * ecat->period;
+                    }
+                    count += missed;
+                }
+                else if (ecat->overrun == OVERRUN_REPHASE)
+                {
+                    if (sent >= next)
+                    {
+                        missed += (sent - next) / ecat->period + 1;
+                        next = sent + ecat->period;
+                    }
+                }
+                wakeupTime.tv_sec = next / NSEC_PER_SEC;
+                wakeupTime.tv_nsec = next % NSEC_PER_SEC;
+                // 超时事件只在此发布，回调由SDO线程调用，不占用已经超时的实时线程
+                if (ecat->overrunLimit > 0 && overruns == ecat->overrunLimit + 1)
+                {
+                    ecat->cycleStats->pending.store(overruns, std::memory_order_release);
+                }
+            }
+            else
+            {
+                overruns = 0;
+            }
+            // 周期统计：发送与超时计入上一次唤醒所在的周期，接收与处理的耗时在处理完全部域时写入
+            if (woken)
             {
-                if (sleep)
+                ecat->cycleStats->begin();
+                ecat->cycleStats->send.record(sent - cycleStart);
+                if (overruns > 0)
                 {
-                    nanosleep(&step, nullptr);
+                    ecat->cycleStats->overruns.store(ecat->cycleStats->overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    ecat->cycleStats->missed.store(ecat->cycleStats->missed.load(std::memory_order_relaxed) + missed, std::memory_order_relaxed);
+                    if (overruns > ecat->cycleStats->streak.load(std::memory_order_relaxed))
+                    {
+                        ecat->cycleStats->streak.store(overruns, std::memory_order_relaxed);
+                    }
                 }
+                ecat->cycleStats->end();
+            }
+            if (ecat->timing == TIMING_SLEEP)
+            {
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeupTime, nullptr) == EINTR)
+                    ;
                 clock_gettime(CLOCK_MONOTONIC, &currentTime);
-                if (sleep && (TIMESPEC2NS(wakeupTime) - TIMESPEC2NS(currentTime) < 12 * ecat->period / 100))
+            }
+            else
+            {
+                if (ecat->timing == TIMING_HYBRID)
+                {
+                    long spinStart = TIMESPEC2NS(wakeupTime) - spin;
+                    spinTime.tv_sec = spinStart / NSEC_PER_SEC;
+                    spinTime.tv_nsec = spinStart % NSEC_PER_SEC;
+                    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spinTime, nullptr) == EINTR)
+                        ;
+                }
+                // spin模式全程不经过取消点，每周期检查一次取消请求，保证clean()能结束本线程
+                pthread_testcancel();
+                do
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+                } while (TIMESPEC2NS(currentTime) < TIMESPEC2NS(wakeupTime));
+            }
+            woken = true;
+            cycleStart = TIMESPEC2NS(currentTime);
+            lateness = cycleStart - TIMESPEC2NS(wakeupTime);
+            // 唤醒时已错过整周期：skip将周期起点前移到唤醒前最近的一个，rephase以唤醒时刻为新的周期起点，
+            // 超时在本周期发送完成后计入；周期计数须与已排队的域一致，到发送完成后再前移
+            late = 0;
+            if (lateness >= ecat->period)
+            {
+                late = lateness / ecat->period;
+                long start = TIMESPEC2NS(wakeupTime);
+                if (ecat->overrun == OVERRUN_SKIP)
+                {
+                    start += late * ecat->period;
+                }
+                else if (ecat->overrun == OVERRUN_REPHASE)
                 {
-                    sleep = false;
+                    start = cycleStart;
                 }
-            } while (TIMESPEC2NS(currentTime) < TIMESPEC2NS(wakeupTime));
+                wakeupTime.tv_sec = start / NSEC_PER_SEC;
+                wakeupTime.tv_nsec = start % NSEC_PER_SEC;
+            }
+            frame.dcTime = 0;
             if (ecat->dc)
             {
                 clock_gettime(CLOCK_MONOTONIC, &currentTime);
-                ecrt_master_application_time(ecat->master, TIMESPEC2NS(currentTime));
+                frame.dcTime = TIMESPEC2NS(currentTime);
+                ecrt_master_application_time(ecat->master, frame.dcTime);
             }
             ecrt_master_receive(ecat->master);
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            frame.cycle = count;
+            frame.rxTime = TIMESPEC2NS(currentTime);
             ecrt_master_state(ecat->master, &masterState);
             if (masterState.slaves_responding != slavesResponding)
             {
                 slavesResponding = masterState.slaves_responding;
+                ecat->sdoTable->epoch.fetch_add(1, std::memory_order_relaxed);
                 printf("master %d slaves_responding changed to %d\n", ecat->order, slavesResponding);
             }
             if (masterState.al_states != alStates)
             {
                 alStates = masterState.al_states;
+                ecat->sdoTable->epoch.fetch_add(1, std::memory_order_relaxed);
                 printf("master %d al_states changed to 0x%02x\n", ecat->order, alStates);
             }
             i = 0;
@@ -1049,9 +1637,12 @@ namespace DriverSDK
                     wcStates[i] = domainStates[i].wc_state;
                     printf("master %d domain %d wc_state changed to %d\n", ecat->order, i, wcStates[i]);
                 }
+                // 每周期都提交，不完整的帧带上实际的wc_state，由读端据此判断数据是否可信
+                frame.workingCounter = domainStates[i].working_counter;
+                frame.wcState = domainStates[i].wc_state;
+                ecat->txPDOSwaps[i]->copyFrom(ecat->domainPtrs[i], ecat->domainSizes[i], &frame);
                 if (domainStates[i].wc_state == EC_WC_COMPLETE)
                 {
-                    ecat->txPDOSwaps[i]->copyFrom(ecat->domainPtrs[i], ecat->domainSizes[i]);
                     int j = 0;
                     while (j < 2)
                     {
@@ -1060,7 +1651,7 @@ namespace DriverSDK
                             j++;
                             continue;
                         }
-                        ConverterDatum const &channel = converters[j].tx->channels[0];
+                        ConverterDatum const &channel = ((ConverterTxData const *)(ecat->domainPtrs[i] + converters[j].tx.offset))->channels[0];
                         if (channel.Index == converters[j].enabled)
                         {
                             j++;
@@ -1102,6 +1693,12 @@ namespace DriverSDK
                 }
                 i++;
             }
+            clock_gettime(CLOCK_MONOTONIC, &currentTime);
+            ecat->cycleStats->begin();
+            ecat->cycleStats->lateness.record(lateness);
+            ecat->cycleStats->process.record(TIMESPEC2NS(currentTime) - frame.rxTime);
+            ecat->cycleStats->loop.record(TIMESPEC2NS(currentTime) - cycleStart);
+            ecat->cycleStats->end();
         }
         return nullptr;
     }
@@ -1112,25 +1709,95 @@ namespace DriverSDK
         {
             return 0;
         }
-        int cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
-        if (cpu > processor)
+        // 配置文件未指定CPU时，主站order的实时线程默认放在从高到低第order个隔离CPU上；
+        // 隔离CPU不足时放在setCPU()指定的CPU及以下、尚未被此前主站占用的最高CPU上，各主站不共用一个CPU
+        cpu_set_t isolated;
+        int isolatedCount = isolatedCPUs(isolated), cpu = -1;
+        if (isolatedCount > order)
         {
-            cpu = processor;
+            int i = CPU_SETSIZE - 1, k = 0;
+            while (i >= 0 && cpu < 0)
+            {
+                if (CPU_ISSET(i, &isolated))
+                {
+                    if (k == order)
+                    {
+                        cpu = i;
+                    }
+                    k++;
+                }
+                i--;
+            }
         }
-        if (pthread_create(&pth, nullptr, &rxtx, this) != 0)
+        else
         {
-            printf("creating ecats[%d] rxtx thread failed\n", order);
-            return -1;
+            cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+            if (cpu > processor)
+            {
+                cpu = processor;
+            }
+            while (cpu >= 0 && CPU_ISSET(cpu, &rxtxCPUs))
+            {
+                cpu--;
+            }
+            if (cpu < 0)
+            {
+                printf("no free cpu left for ecats[%d] rxtx thread\n", order);
+                return -1;
+            }
         }
         cpu_set_t cpuset;
         CPU_ZERO(&cpuset);
         CPU_SET(cpu, &cpuset);
-        if (pthread_setaffinity_np(pth, sizeof(cpu_set_t), &cpuset) != 0)
+        std::string name = "ecat." + std::to_string(order);
+        std::vector<std::string> thread = configXML->thread(name.c_str());
+        if (thread.size() == 3 && thread[2].size() > 0)
+        {
+            cpuList(thread[2].c_str(), cpuset);
+        }
+        cpu_set_t overlap;
+        CPU_AND(&overlap, &cpuset, &rxtxCPUs);
+        if (CPU_COUNT(&overlap) > 0)
+        {
+            printf("ecats[%d] rxtx thread cpus are shared with another master\n", order);
+            if (exclusive)
+            {
+                return -1;
+            }
+        }
+        if (exclusive)
         {
-            printf("setting ecats[%d] rxtx thread cpu affinity failed\n", order);
+            // 独占模式：本主站实时线程所在CPU不再运行其他SDK线程，且须已被内核隔离，否则其他进程仍会被调度到该CPU上
+            CPU_AND(&overlap, &cpuset, &isolated);
+            if (!CPU_EQUAL(&overlap, &cpuset))
+            {
+                printf("ecats[%d] exclusive cpus are not isolated, consider isolcpus and nohz_full\n", order);
+                return -1;
+            }
+        }
+        CPU_OR(&rxtxCPUs, &rxtxCPUs, &cpuset);
+        if (threadCreate(&pth, name.c_str(), &rxtx, this, &cpuset, exclusive) != 0)
+        {
+            printf("creating ecats[%d] rxtx thread failed\n", order);
+            return -1;
+        }
+        cpu_set_t others;
+        CPU_ZERO(&others);
+        int i = 0;
+        while (i < sysconf(_SC_NPROCESSORS_ONLN))
+        {
+            if (!CPU_ISSET(i, &cpuset))
+            {
+                CPU_SET(i, &others);
+            }
+            i++;
+        }
+        name += ".sdo";
+        if (threadCreate(&sdoPth, name.c_str(), &sdoEngine, this, CPU_COUNT(&others) > 0 ? &others : nullptr) != 0)
+        {
+            printf("creating ecats[%d] sdo thread failed\n", order);
             return -1;
         }
-        printf("ecats[%d] rxtx on cpu %d\n", order, cpu);
         auto itr = alias2slave.begin();
         while (itr != alias2slave.end())
         {
@@ -1144,10 +1811,25 @@ namespace DriverSDK
 
     void ECAT::clean()
     {
+        // 先等实时线程与SDO线程退出，再释放主站与交换列表，线程不会再访问已释放的对象
+        if (sdoPth > 0)
+        {
+            pthread_cancel(sdoPth);
+        }
         if (pth > 0)
         {
             pthread_cancel(pth);
         }
+        if (sdoPth > 0)
+        {
+            pthread_join(sdoPth, nullptr);
+            sdoPth = 0;
+        }
+        if (pth > 0)
+        {
+            pthread_join(pth, nullptr);
+            pth = 0;
+        }
         if (fd > -1)
         {
             close(fd);
@@ -1195,5 +1877,16 @@ namespace DriverSDK
     ECAT::~ECAT()
     {
         clean();
+        int i = 0;
+        while (i < SDO_LANES)
+        {
+            delete sdoRequestQueues[i];
+            i++;
+        }
+        delete sdoTable;
+        delete sdoPool;
+        delete[] sdoSlaveStats;
+        delete[] sdoObjectStats;
+        delete cycleStats;
     }
 }
\ No newline at end of file
@@ -17,7 +17,7 @@
 
 #pragma once
 
-#include "ptr_que.h"
+#include "ptr_ring.h"
 #include "common.h"
 
 namespace DriverSDK
@@ -25,24 +25,39 @@ namespace DriverSDK
     class ECAT
     {
     public:
-        bool dc, sdoRequestable;
-        int order, fd, effectorAlias, sensorAlias, *domainSizes;
+        bool dc, exclusive, sdoRequestable;
+        int order, fd, refresh, effectorAlias, sensorAlias, *domainSizes;
         std::map<int, std::string> alias2type;
-        long period;
+        int timing, overrun, overrunLimit;
+        long period, spin;
         std::map<int, int> alias2slave, alias2domain;
         std::vector<int> domainDivision;
         ec_domain_t **domains;
         unsigned char **domainPtrs;
         SwapList **rxPDOSwaps, **txPDOSwaps;
-        PtrQue<SDOMsg> sdoRequestQueue, sdoResponseQueue;
+        std::vector<std::vector<SwapRange>> rxPDORanges, txPDORanges;
+        std::vector<std::vector<SDOCache>> sdoCaches;
+        PtrRing<SDOMsg> *sdoRequestQueues[SDO_LANES];
+        SDOTable *sdoTable;
+        PtrPool<SDOMsg> *sdoPool;
+        SDOStats *sdoSlaveStats, *sdoObjectStats;
+        CycleStats *cycleStats;
         ec_master_t *master;
-        pthread_t pth;
+        pthread_t pth, sdoPth;
         ECAT(int const order);
         int init();
         int readAlias(unsigned short const slave, std::string const &category, unsigned short const index, unsigned char const subindex, unsigned char const bitLength);
         int requestState(unsigned short const slave, char const *stateString);
         int check();
         int config();
+        static int sdoStep(SDOMsg *sdoMsg, long const now);
+        void sdoRecord(SDOMsg const *sdoMsg, long const now);
+        void sdoFinish(SDOMsg *sdoMsg, long const now);
+        SDOCache *sdoCache(SDOMsg const *sdoMsg);
+        bool sdoCached(SDOMsg *sdoMsg, long const now);
+        static unsigned short controlWord(unsigned short const statusWord, int const desired, unsigned short const previous);
+        static void *sdoEngine(void *arg);
+        static long spinWindow(long const period);
         static void *rxtx(void *arg);
         int run();
         void clean();
@@ -21,10 +21,17 @@
 #include "rs232.h"
 #include "rs485.h"
 #include "ecat.h"
+#include "conversion.h"
 #include <unistd.h>
+#include <sys/mman.h>
 #include <atomic>
 #include <sstream>
 #include <limits>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace DriverSDK
 {
@@ -42,6 +49,10 @@ namespace DriverSDK
     std::vector<char> operatingMode;    // 操作模式
     std::vector<unsigned short> maxCurrent;    // 最大电流
     std::atomic<bool> ecatStalled;    // ECAT停滞
+    std::atomic<long> temperaturePeriod;    // 温度轮询周期（纳秒），每个电机在该周期内被读取一次，0为停止轮询
+    std::atomic<long> sdoSlack;    // 发起SDO读写所需的最小周期余量（周期的百分比）
+    std::function<void(int const, unsigned int const)> overrunCallback;    // 连续超时周期数超过主站overrun_limit时由该主站的SDO线程调用
+    MotorConversion conversion;    // 电机单位换算系数
 
     std::vector<RS485> *rs485sPtr;
 
@@ -63,14 +74,35 @@ namespace DriverSDK
         IMU *imu;
         std::vector<RS485> rs485s;
         std::vector<ECAT> ecats;
+        std::vector<short> temperatures;
+        std::vector<unsigned short> statusWords, errorCodes;
+        std::vector<int> positions, velocities, torques;   // 读取电机实际值时的原始值暂存，与设置目标的换算暂存分开
+        std::vector<float> actualPos, actualVel, actualTor; // 结构体形式的获取接口换算后的暂存
+        std::mutex fetchMutex;                             // 读端锁：交换列表只允许一个读端，各获取接口在锁内取最新节点并读完数据与帧元数据
+        std::vector<int> sdoTypes;                         // 各关节的ECAT设备类型下标，不在ECAT总线上为-1
+        std::vector<std::string> sdoTypeNames;             // ECAT设备类型名
+        std::map<std::string, int> sdoHandles;             // “类型/对象名”到句柄的映射，仅在解析时访问
+        SDOEntry sdoEntries[SDO_HANDLE_COUNT];             // 句柄表，已发布的表项不再改变
+        std::atomic<int> sdoEntryCount;                    // 已发布的表项数
+        std::mutex sdoMutex;                               // 解析新对象名时持有
         impClass();
         int effectorCheck(std::vector<std::map<int, std::string>> alias2type, char const *bus);
         int init(char const *xmlFile);
-        int putDriverSDORequest(SDOMsg const &msg, int const priority = QUE_PRI_LOW);
+        int submitDriverSDORequest(SDOMsg &msg, int const priority, int const timeout, std::function<void(SDOMsg const &)> *callback);
+        int putDriverSDORequest(SDOMsg &msg, int const priority = SDO_PRI_LOW);
         int getDriverSDOResponse(SDOMsg &msg);
         void rs485Update();
         void ecatUpdate();
+        void rs485Fetch();
+        void ecatFetch();
         void sdoRequestableUpdate();
+        int sdoResolve(int const type, char const *object);
+        void sdoStatsAdd(sdoStatsStruct &data, SDOStats const &stats);
+        void cycleHistFill(cycleHistStruct &data, Histogram const &histogram);
+        int motorTarget(float const *pos, float const *vel, float const *tor);
+        int motorRead(float *pos, float *vel, float *tor, short *temp, unsigned short *statusWord, unsigned short *errorCode);
+        int motorActual(float *pos, float *vel, float *tor, short *temp, unsigned short *statusWord, unsigned short *errorCode);
+        int motorActual(motorActualStruct *data, frameStruct *frames);
         ~impClass();
     };
 
@@ -84,6 +116,9 @@ namespace DriverSDK
         digits = nullptr;
         processor = sysconf(_SC_NPROCESSORS_ONLN) - 1;
         ecatStalled.store(false);
+        sdoEntryCount.store(0);
+        temperaturePeriod.store(100000000L);
+        sdoSlack.store(20);
         rs485sPtr = &rs485s;
         imu = nullptr;
         rs485s.reserve(8);
@@ -143,6 +178,13 @@ namespace DriverSDK
     // 初始化
     int DriverSDK::impClass::init(char const *xmlFile)
     {
+        // 锁定当前与以后映射的全部内存，并预先触及本线程的栈，运行中不再发生缺页
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        {
+            printf("mlockall failed\n");
+        }
+        stackPrefault();
+        Arena::instance().init(ARENA_SIZE);
         configXML = new ConfigXML(xmlFile);
         std::vector<std::vector<int>> motorAlias = configXML->motorAlias();
         if (motorAlias.size() != 6)
@@ -168,6 +210,20 @@ namespace DriverSDK
         if (dofAll > 0)
         {
             drivers = new WrapperPair<DriverRxData, DriverTxData, MotorParameters>[dofAll];
+            if (conversion.init(dofAll) < 0)
+            {
+                printf("motor conversion init failed\n");
+                return -1;
+            }
+            temperatures.assign(dofAll, 0);
+            statusWords.assign(dofAll, 0xffff);
+            errorCodes.assign(dofAll, 0);
+            positions.assign(dofAll, 0);
+            velocities.assign(dofAll, 0);
+            torques.assign(dofAll, 0);
+            actualPos.assign(dofAll, 0);
+            actualVel.assign(dofAll, 0);
+            actualTor.assign(dofAll, 0);
         }
         if (dofLeg > 0)
         {
@@ -194,6 +250,26 @@ namespace DriverSDK
             printf("invalid effector configuration\n");
             return -1;
         }
+        sdoTypes.assign(dofAll, -1);
+        int k = 0;
+        while (k < ecatAlias2type.size())
+        {
+            auto itr = ecatAlias2type[k].begin();
+            while (itr != ecatAlias2type[k].end())
+            {
+                if (itr->first > 0 && itr->first <= dofAll)
+                {
+                    auto name = std::find(sdoTypeNames.begin(), sdoTypeNames.end(), itr->second);
+                    sdoTypes[itr->first - 1] = name - sdoTypeNames.begin();
+                    if (name == sdoTypeNames.end())
+                    {
+                        sdoTypeNames.push_back(itr->second);
+                    }
+                }
+                itr++;
+            }
+            k++;
+        }
         rs485emuAlias2type = configXML->alias2type("RS485Emu");
         int i = 0;
         while (i < rs485emuAlias2type.size())
@@ -253,6 +329,12 @@ namespace DriverSDK
             return -1;
         };
         i = 0;
+        while (i < dofAll)
+        {
+            drivers[i].parameters.mode.store(operatingMode[i]);
+            i++;
+        }
+        i = 0;
         if (maxCurrent.size() == 0)
         {
             while (i < dofAll)
@@ -267,7 +349,7 @@ namespace DriverSDK
             return -1;
         }
         imu = new IMU(configXML->imuDevice().c_str(), configXML->imuBaudrate(), 50, 0xfa, 0xff);
-        if (imu->run() < 0)
+        if (imu->run("imu") < 0)
         {
             printf("imu run failed\n");
             return -1;
@@ -337,6 +419,15 @@ namespace DriverSDK
             i++;
         }
         i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order >= 0)
+            {
+                conversion.update(i, drivers[i].parameters);
+            }
+            i++;
+        }
+        i = 0;
         while (i < motorAlias.size())
         {
             printf("limb %d\n", i);
@@ -404,16 +495,6 @@ namespace DriverSDK
             i++;
         }
         i = 0;
-        while (i < ecats.size())
-        {
-            if (ecats[i].pth > 0 && pthread_detach(ecats[i].pth) != 0)
-            {
-                printf("detaching ecats[%d] rxtx thread failed\n", i);
-                return -1;
-            }
-            i++;
-        }
-        i = 0;
         while (i < rs485s.size())
         {
             if (rs485s[i].run() < 0)
@@ -436,48 +517,55 @@ namespace DriverSDK
         return 0;
     }
 
-    int DriverSDK::impClass::putDriverSDORequest(SDOMsg const &msg, int const priority)
+    // 提交驱动器SDO请求：按优先级进入对应通道，timeout为毫秒；带回调时结果经回调返回（回调由SDO线程释放），否则按票号取回
+    int DriverSDK::impClass::submitDriverSDORequest(SDOMsg &msg, int const priority, int const timeout, std::function<void(SDOMsg const &)> *callback)
     {
-        if (ecats[drivers[msg.alias - 1].order].sdoRequestable && drivers[msg.alias - 1].tx->StatusWord > 0)
+        ECAT &ecat = ecats[drivers[msg.alias - 1].order];
+        if (drivers[msg.alias - 1].parameters.statusWord.load(std::memory_order_relaxed) == 0)
         {
-            SDOMsg *sdoMsg = new SDOMsg();
-            *sdoMsg = msg;
-            sdoMsg->state = 0;
-            ecats[drivers[msg.alias - 1].order].sdoRequestQueue.put(sdoMsg, priority);
-            return 0;
+            return -1;
         }
-        return -1;
+        SDOMsg *sdoMsg = ecat.sdoPool->get();
+        if (sdoMsg == nullptr)
+        {
+            return -1;
+        }
+        *sdoMsg = msg;
+        sdoMsg->state = 0;
+        sdoMsg->priority = priority > SDO_PRI_LOW ? SDO_PRI_HIGH : SDO_PRI_LOW;
+        struct timespec currentTime;
+        clock_gettime(CLOCK_MONOTONIC, &currentTime);
+        sdoMsg->issued = TIMESPEC2NS(currentTime);
+        sdoMsg->deadline = sdoMsg->issued + timeout * 1000000L;
+        sdoMsg->retries = 0;
+        sdoMsg->callback = callback;
+        sdoMsg->ticket = ecat.sdoTable->issue();
+        if (ecat.sdoRequestQueues[sdoMsg->priority]->put(sdoMsg) < 0)
+        {
+            sdoMsg->callback = nullptr;
+            ecat.sdoPool->put(sdoMsg);
+            return -1;
+        }
+        msg.ticket = sdoMsg->ticket;
+        return 0;
     }
 
-    // 获取驱动器SDO响应
-    int DriverSDK::impClass::getDriverSDOResponse(SDOMsg &msg)
+    // 放入驱动器SDO请求，结果由getDriverSDOResponse按票号取回
+    int DriverSDK::impClass::putDriverSDORequest(SDOMsg &msg, int const priority)
     {
-        SDOMsg *sdoMsg = ecats[drivers[msg.alias - 1].order].sdoResponseQueue.get_nonblocking();
-        if (sdoMsg != nullptr)
+        if (ecats[drivers[msg.alias - 1].order].sdoRequestable)
         {
-            if (sdoMsg->alias == msg.alias && sdoMsg->index == msg.index && sdoMsg->subindex == msg.subindex && sdoMsg->operation == msg.operation)
-            {
-                msg.state = sdoMsg->state;
-                msg.value = sdoMsg->value;
-                delete sdoMsg;
-                return 0;
-            }
-            else
-            {
-                sdoMsg->recycled++;
-                if (sdoMsg->recycled < dofAll)
-                {
-                    ecats[drivers[msg.alias - 1].order].sdoResponseQueue.put(sdoMsg, QUE_PRI_HIGH);
-                }
-                else
-                {
-                    delete sdoMsg;
-                }
-            }
+            return submitDriverSDORequest(msg, priority, SDO_TIMEOUT, nullptr);
         }
         return -1;
     }
 
+    // 获取驱动器SDO响应
+    int DriverSDK::impClass::getDriverSDOResponse(SDOMsg &msg)
+    {
+        return ecats[drivers[msg.alias - 1].order].sdoTable->lookup(msg);
+    }
+
     // RS485更新
     void DriverSDK::impClass::rs485Update()
     {
@@ -486,7 +574,7 @@ namespace DriverSDK
         {
             if (rs485s[i].rxSwap != nullptr)
             {
-                rs485s[i].rxSwap->advanceNodePtr();
+                rs485s[i].rxSwap->commit();
             }
             i++;
         }
@@ -519,19 +607,6 @@ namespace DriverSDK
             channel.ID = alias;
             channel.Length = length;
             memcpy(channel.Data, data, length);
-            ecats[converters[alias - 200].order].rxPDOSwaps[converters[alias - 200].domain]->advanceNodePtr();
-            channel = converters[alias - 200].rx->channels[0];
-            channel.Index = count;
-            channel.ID = alias;
-            channel.Length = length;
-            memcpy(channel.Data, data, length);
-            ecats[converters[alias - 200].order].rxPDOSwaps[converters[alias - 200].domain]->advanceNodePtr();
-            channel = converters[alias - 200].rx->channels[0];
-            channel.Index = count;
-            channel.ID = alias;
-            channel.Length = length;
-            memcpy(channel.Data, data, length);
-            ecats[converters[alias - 200].order].rxPDOSwaps[converters[alias - 200].domain]->advanceNodePtr();
             int j = 0;
             while (j < length)
             {
@@ -549,7 +624,42 @@ namespace DriverSDK
             {
                 if (ecats[i].rxPDOSwaps[j] != nullptr)
                 {
-                    ecats[i].rxPDOSwaps[j]->advanceNodePtr();
+                    ecats[i].rxPDOSwaps[j]->commit();
+                }
+                j++;
+            }
+            i++;
+        }
+    }
+
+    // RS485读取最新数据
+    // 调用者须持有fetchMutex
+    void DriverSDK::impClass::rs485Fetch()
+    {
+        int i = 0;
+        while (i < rs485s.size())
+        {
+            if (rs485s[i].txSwap != nullptr)
+            {
+                rs485s[i].txSwap->fetch();
+            }
+            i++;
+        }
+    }
+
+    // ECAT读取最新数据，之后直到下一次读取前所有tx数据都来自同一总线周期
+    // 调用者须持有fetchMutex
+    void DriverSDK::impClass::ecatFetch()
+    {
+        int i = 0;
+        while (i < ecats.size())
+        {
+            int j = 0;
+            while (j < ecats[i].domainDivision.size())
+            {
+                if (ecats[i].txPDOSwaps[j] != nullptr)
+                {
+                    ecats[i].txPDOSwaps[j]->fetch();
                 }
                 j++;
             }
@@ -563,7 +673,7 @@ namespace DriverSDK
         int i = 0;
         while (i < ecats.size())
         {
-            if (ecats[i].sdoRequestQueue.size() < dofAll && ecats[i].sdoResponseQueue.size() < dofAll)
+            if (ecats[i].sdoRequestQueues[SDO_PRI_LOW]->size() < dofAll)
             {
                 ecats[i].sdoRequestable = true;
             }
@@ -575,6 +685,188 @@ namespace DriverSDK
         }
     }
 
+    // 解析设备类型下的对象名，返回句柄；同一类型同一对象只查询一次配置文件，之后只做一次映射查找
+    int DriverSDK::impClass::sdoResolve(int const type, char const *object)
+    {
+        if (configXML == nullptr || type < 0 || type >= sdoTypeNames.size() || object == nullptr)
+        {
+            return -1;
+        }
+        std::lock_guard<std::mutex> lock(sdoMutex);
+        std::string key = sdoTypeNames[type] + "/" + object;
+        auto itr = sdoHandles.find(key);
+        if (itr != sdoHandles.end())
+        {
+            return itr->second;
+        }
+        int handle = sdoEntryCount.load(std::memory_order_relaxed);
+        if (handle >= SDO_HANDLE_COUNT)
+        {
+            printf("sdo handle table full, %s not resolved\n", key.c_str());
+            return -1;
+        }
+        std::vector<std::string> entry = configXML->entry(configXML->busDevice("ECAT", sdoTypeNames[type].c_str()), object);
+        if (entry.size() < 6)
+        {
+            printf("object %s not found\n", key.c_str());
+            return -1;
+        }
+        sdoEntries[handle].type = type;
+        sdoEntries[handle].index = (unsigned short)strtoul(entry[1].c_str(), nullptr, 16);
+        sdoEntries[handle].subindex = (unsigned char)strtoul(entry[2].c_str(), nullptr, 16);
+        sdoEntries[handle].signed_ = (unsigned char)strtoul(entry[3].c_str(), nullptr, 10);
+        sdoEntries[handle].bitLength = (unsigned char)strtoul(entry[4].c_str(), nullptr, 10);
+        sdoEntries[handle].operation = (unsigned char)strtoul(entry[5].c_str(), nullptr, 10);
+        sdoEntryCount.store(handle + 1, std::memory_order_release);
+        sdoHandles[key] = handle;
+        return handle;
+    }
+
+    // 电机目标值换算并写入PDO；状态机由ECAT周期线程按各驱动器的enabled推进，这里只为清除错误发送SDO；pos、vel、tor须含dofAll个元素
+    int DriverSDK::impClass::motorTarget(float const *pos, float const *vel, float const *tor)
+    {
+        conversion.targets(dofAll, pos, vel, tor, conversion.position, conversion.velocity, conversion.torque);
+        int i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order < 0)
+            {
+                i++;
+                continue;
+            }
+            drivers[i].rx->TargetPosition = conversion.position[i];
+            drivers[i].rx->TargetVelocity = conversion.velocity[i];
+            drivers[i].rx->VelocityOffset = conversion.velocity[i];
+            char const mode = drivers[i].parameters.mode.load(std::memory_order_relaxed);
+            if (mode == 8)
+            {
+                drivers[i].rx->TargetTorque = 0;
+                drivers[i].rx->TorqueOffset = conversion.torque[i];
+            }
+            else if (mode == 10)
+            {
+                drivers[i].rx->TargetTorque = conversion.torque[i];
+                drivers[i].rx->TorqueOffset = 0;
+            }
+            else
+            {
+                ;
+            }
+            i++;
+        }
+        i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order < 0 || drivers[i].desired != -1)
+            {
+                i++;
+                continue;
+            }
+            if (drivers[i].parameters.clearErrorSDO.ticket == 0)
+            {
+                putDriverSDORequest(drivers[i].parameters.clearErrorSDO, SDO_PRI_HIGH);
+            }
+            if (getDriverSDOResponse(drivers[i].parameters.clearErrorSDO) == 0)
+            {
+                if (drivers[i].parameters.clearErrorSDO.state < 0)
+                {
+                    printf("requesting drivers[%d] clearError failed\n", i);
+                }
+            }
+            i++;
+        }
+        ecatUpdate();
+        return 0;
+    }
+
+    // 读取电机实际值并换算，结果按结构数组写入各输出数组，每个数组须含dofAll个元素；调用者须持有fetchMutex
+    int DriverSDK::impClass::motorRead(float *pos, float *vel, float *tor, short *temp, unsigned short *statusWord, unsigned short *errorCode)
+    {
+        if (ecatStalled.load())
+        {
+            return -1;
+        }
+        ecatFetch();
+        int i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order < 0)
+            {
+                positions[i] = velocities[i] = torques[i] = 0;
+                i++;
+                continue;
+            }
+            positions[i] = drivers[i].tx->ActualPosition;
+            velocities[i] = drivers[i].tx->ActualVelocity;
+            torques[i] = drivers[i].tx->ActualTorque;
+            i++;
+        }
+        conversion.actuals(dofAll, positions.data(), velocities.data(), torques.data(), pos, vel, tor);
+        i = 0;
+        while (i < dofAll)
+        {
+            if (drivers[i].order < 0)
+            {
+                statusWord[i] = 0xffff;
+                i++;
+                continue;
+            }
+            temp[i] = drivers[i].parameters.temperature.load(std::memory_order_relaxed);
+            statusWord[i] = drivers[i].tx->StatusWord;
+            errorCode[i] = drivers[i].tx->ErrorCode;
+            i++;
+        }
+        sdoRequestableUpdate();
+        return 0;
+    }
+
+    // 读取电机实际值，结构数组形式
+    int DriverSDK::impClass::motorActual(float *pos, float *vel, float *tor, short *temp, unsigned short *statusWord, unsigned short *errorCode)
+    {
+        std::lock_guard<std::mutex> lock(fetchMutex);
+        return motorRead(pos, vel, tor, temp, statusWord, errorCode);
+    }
+
+    // 读取电机实际值，结构体形式；frames不为空时一并写入各电机所属帧的元数据，与数据取自同一次fetch
+    int DriverSDK::impClass::motorActual(motorActualStruct *data, frameStruct *frames)
+    {
+        std::lock_guard<std::mutex> lock(fetchMutex);
+        if (motorRead(actualPos.data(), actualVel.data(), actualTor.data(), temperatures.data(), statusWords.data(), errorCodes.data()) != 0)
+        {
+            return -1;
+        }
+        int i = 0;
+        while (i < dofAll)
+        {
+            data[i].statusWord = statusWords[i];
+            if (drivers[i].order < 0)
+            {
+                if (frames != nullptr)
+                {
+                    frames[i] = frameStruct{0, 0, 0, 0, -1};
+                }
+                i++;
+                continue;
+            }
+            data[i].pos = actualPos[i];
+            data[i].vel = actualVel[i];
+            data[i].tor = actualTor[i];
+            data[i].temp = temperatures[i];
+            data[i].errorCode = errorCodes[i];
+            if (frames != nullptr)
+            {
+                FrameInfo const &frame = ecats[drivers[i].order].txPDOSwaps[drivers[i].domain]->frame();
+                frames[i].cycle = frame.cycle;
+                frames[i].rxTime = frame.rxTime;
+                frames[i].dcTime = frame.dcTime;
+                frames[i].workingCounter = frame.workingCounter;
+                frames[i].wcState = frame.wcState;
+            }
+            i++;
+        }
+        return 0;
+    }
+
     // 驱动SDK类析构函数
     DriverSDK::impClass::~impClass()
     {
@@ -638,6 +930,31 @@ namespace DriverSDK
         processor = cpu;
     }
 
+    // 设置温度轮询周期（毫秒），0为停止轮询
+    void DriverSDK::setTempPeriod(unsigned int const period)
+    {
+        temperaturePeriod.store(period * 1000000L);
+    }
+
+    // 设置连续超时回调
+    int DriverSDK::setOverrunCallback(std::function<void(int const, unsigned int const)> const &callback)
+    {
+        // 各主站的SDO线程不加锁读取回调，init()之后不再允许修改
+        if (configXML != nullptr)
+        {
+            printf("overrun callback should be set before init\n");
+            return -1;
+        }
+        overrunCallback = callback;
+        return 0;
+    }
+
+    // 设置发起SDO读写所需的最小周期余量
+    void DriverSDK::setSDOSlack(unsigned int const percent)
+    {
+        sdoSlack.store(percent > 100 ? 100 : percent);
+    }
+
     // 设置最大电流
     void DriverSDK::setMaxCurr(std::vector<unsigned short> const &maxCurr)
     {
@@ -660,6 +977,7 @@ namespace DriverSDK
         while (i < dofAll)
         {
             operatingMode[i] = mode[i];
+            drivers[i].parameters.mode.store(mode[i]);
             i++;
         }
         return 0;
@@ -739,6 +1057,7 @@ namespace DriverSDK
         while (i < dofAll)
         {
             drivers[i].parameters.countBias = cntBias[i];
+            conversion.update(i, drivers[i].parameters);
             i++;
         }
         return 0;
@@ -751,23 +1070,36 @@ namespace DriverSDK
         {
             return -1;
         }
-        std::map<int, std::string>::iterator itr;
-        int i = 0;
-        while (i < ecatAlias2type.size())
+        if (imp.sdoTypes[data.i] < 0)
         {
-            itr = ecatAlias2type[i].begin();
-            while (itr != ecatAlias2type[i].end())
-            {
-                if (itr->first == data.i + 1)
-                {
-                    i = ecatAlias2type.size() - 1;
-                    break;
-                }
-                itr++;
-            }
-            i++;
+            return fillSDO(data, -1);
+        }
+        int handle = imp.sdoResolve(imp.sdoTypes[data.i], object);
+        if (handle < 0)
+        {
+            return -1;
         }
-        if (ecatAlias2type.size() == 0 || itr == ecatAlias2type[ecatAlias2type.size() - 1].end())
+        return fillSDO(data, handle);
+    }
+
+    // 获取对象字典句柄：按驱动器i的设备类型解析对象名，同类型的驱动器共用句柄；失败返回-1
+    int DriverSDK::getSDOHandle(int const i, char const *object)
+    {
+        if (configXML == nullptr || i < 0 || i >= dofAll)
+        {
+            return -1;
+        }
+        return imp.sdoResolve(imp.sdoTypes[i], object);
+    }
+
+    // 按句柄填充SDO，不访问配置文件；驱动器不在ECAT总线上时与按名填充一样返回1
+    int DriverSDK::fillSDO(motorSDOClass &data, int const handle)
+    {
+        if (configXML == nullptr || data.i < 0 || data.i >= dofAll)
+        {
+            return -1;
+        }
+        if (imp.sdoTypes[data.i] < 0)
         {
             data.value = 0;
             data.state = 3;
@@ -775,53 +1107,60 @@ namespace DriverSDK
             data.subindex = 0x00;
             return 1;
         }
-        std::vector<std::string> entry = configXML->entry(configXML->busDevice("ECAT", itr->second.c_str()), object);
+        if (handle < 0 || handle >= imp.sdoEntryCount.load(std::memory_order_acquire) || imp.sdoEntries[handle].type != imp.sdoTypes[data.i])
+        {
+            return -1;
+        }
+        SDOEntry const &entry = imp.sdoEntries[handle];
         data.value = 0;
         data.state = 0;
-        data.index = (unsigned short)strtoul(entry[1].c_str(), nullptr, 16);
-        data.subindex = (unsigned char)strtoul(entry[2].c_str(), nullptr, 16);
-        data.signed_ = (unsigned char)strtoul(entry[3].c_str(), nullptr, 10);
-        data.bitLength = (unsigned char)strtoul(entry[4].c_str(), nullptr, 10);
-        data.operation = (unsigned char)strtoul(entry[5].c_str(), nullptr, 10);
+        data.index = entry.index;
+        data.subindex = entry.subindex;
+        data.signed_ = entry.signed_;
+        data.bitLength = entry.bitLength;
+        data.operation = entry.operation;
         return 0;
     }
 
     // 获取IMU
     void DriverSDK::getIMU(imuStruct &data)
     {
-        float f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 7) * Pi / 180.0;
+        std::lock_guard<std::mutex> lock(imp.fetchMutex);
+        imp.imu->txSwap->fetch();
+        unsigned char const *frame = imp.imu->txSwap->reader();
+        float f = imp.imu->quadchar2float(frame + 7) * Pi / 180.0;
         if (f > -4.0 && f < 4.0)
         {
             data.rpy[0] = f;
         }
-        f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 11) * Pi / 180.0;
+        f = imp.imu->quadchar2float(frame + 11) * Pi / 180.0;
         if (f > -4.0 && f < 4.0)
         {
             data.rpy[1] = f;
         }
-        f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 15) * Pi / 180.0;
+        f = imp.imu->quadchar2float(frame + 15) * Pi / 180.0;
         if (f > -4.0 && f < 4.0)
         {
             data.rpy[2] = f;
         }
-        f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 37);
+        f = imp.imu->quadchar2float(frame + 37);
         if (f > -40.0 && f < 40.0)
         {
             data.gyr[0] = f;
         }
-        f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 41);
+        f = imp.imu->quadchar2float(frame + 41);
         if (f > -40.0 && f < 40.0)
         {
             data.gyr[1] = f;
         }
-        f = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 45);
+        f = imp.imu->quadchar2float(frame + 45);
         if (f > -40.0 && f < 40.0)
         {
             data.gyr[2] = f;
         }
-        data.acc[0] = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 22);
-        data.acc[1] = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 26);
-        data.acc[2] = imp.imu->quadchar2float(imp.imu->txSwap->nodePtr.load()->memPtr + 30);
+        data.acc[0] = imp.imu->quadchar2float(frame + 22);
+        data.acc[1] = imp.imu->quadchar2float(frame + 26);
+        data.acc[2] = imp.imu->quadchar2float(frame + 30);
     }
     
     // 获取传感器
@@ -831,6 +1170,8 @@ namespace DriverSDK
         {
             return -1;
         }
+        std::lock_guard<std::mutex> lock(imp.fetchMutex);
+        imp.ecatFetch();
         int i = 0;
         while (i < 2)
         {
@@ -883,6 +1224,9 @@ namespace DriverSDK
         {
             return -1;
         }
+        std::lock_guard<std::mutex> lock(imp.fetchMutex);
+        imp.rs485Fetch();
+        imp.ecatFetch();
         int i = 0;
         while (i < dofEffector)
         {
@@ -899,161 +1243,74 @@ namespace DriverSDK
         {
             return -1;
         }
+        return setMotorTarget(data.data(), dofAll);
+    }
+
+    // 设置电机目标，data指向count个连续的motorTargetStruct，count须等于getTotalMotorNr()
+    int DriverSDK::setMotorTarget(motorTargetStruct const *data, int const count)
+    {
+        if (count != dofAll)
+        {
+            return -1;
+        }
         int i = 0;
         while (i < dofAll)
         {
-            if (drivers[i].order < 0)
-            {
-                i++;
-                continue;
-            }
-            float position = data[i].pos;
-            if (position < drivers[i].parameters.minimumPosition)
-            {
-                position = drivers[i].parameters.minimumPosition;
-            }
-            else if (position > drivers[i].parameters.maximumPosition)
-            {
-                position = drivers[i].parameters.maximumPosition;
-            }
-            position = drivers[i].parameters.polarity * position * drivers[i].parameters.gearRatioPosVel * drivers[i].parameters.encoderResolution / 2.0 / Pi + drivers[i].parameters.countBias;
-            drivers[i].rx->TargetPosition = position;
-            float velocity = data[i].vel;
-            velocity = drivers[i].parameters.polarity * velocity * drivers[i].parameters.gearRatioPosVel * drivers[i].parameters.encoderResolution / 2.0 / Pi;
-            drivers[i].rx->TargetVelocity = velocity;
-            drivers[i].rx->VelocityOffset = velocity;
-            float torque = data[i].tor;
-            if (torque > drivers[i].parameters.maximumTorque)
-            {
-                torque = drivers[i].parameters.maximumTorque;
-            }
-            else if (torque < -drivers[i].parameters.maximumTorque)
-            {
-                torque = -drivers[i].parameters.maximumTorque;
-            }
-            torque = drivers[i].parameters.polarity * 1000.0 * torque / drivers[i].parameters.torqueConstant / drivers[i].parameters.gearRatioTor / drivers[i].parameters.ratedCurrent;
-            if (operatingMode[i] == 8)
-            {
-                drivers[i].rx->TargetTorque = 0;
-                drivers[i].rx->TorqueOffset = torque;
-            }
-            else if (operatingMode[i] == 10)
-            {
-                drivers[i].rx->TargetTorque = torque;
-                drivers[i].rx->TorqueOffset = 0;
-            }
-            else
-            {
-                ;
-            }
-            drivers[i].enabled = data[i].enabled;
+            conversion.pos[i] = data[i].pos;
+            conversion.vel[i] = data[i].vel;
+            conversion.tor[i] = data[i].tor;
+            drivers[i].desired = data[i].enabled;
             i++;
         }
-        i = 0;
+        return imp.motorTarget(conversion.pos, conversion.vel, conversion.tor);
+    }
+
+    // 设置电机目标（结构数组），各数组须含getTotalMotorNr()个元素，可直接传入Eigen::Map等连续存储，不做长度检查
+    int DriverSDK::setMotorTarget(float const *pos, float const *vel, float const *tor, int const *enabled)
+    {
+        int i = 0;
         while (i < dofAll)
         {
-            if (drivers[i].order < 0)
-            {
-                i++;
-                continue;
-            }
-            switch (drivers[i].enabled)
-            {
-            case 1:
-                switch (drivers[i].tx->StatusWord & 0x007f)
-                {
-                case 0x0031:
-                    drivers[i].rx->Mode = operatingMode[i];
-                    drivers[i].rx->ControlWord = 0x07;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->Mode = operatingMode[i];
-                    drivers[i].rx->ControlWord = 0x07;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->Mode = operatingMode[i];
-                    drivers[i].rx->ControlWord = 0x07;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    break;
-                case 0x0033:
-                    drivers[i].rx->ControlWord = 0x0f;
-                    drivers[i].rx->TargetPosition = drivers[i].tx->ActualPosition;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->ControlWord = 0x0f;
-                    drivers[i].rx->TargetPosition = drivers[i].tx->ActualPosition;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->ControlWord = 0x0f;
-                    drivers[i].rx->TargetPosition = drivers[i].tx->ActualPosition;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    break;
-                case 0x0037:
-                    drivers[i].rx->Mode = operatingMode[i];
-                    break;
-                default:
-                    drivers[i].rx->ControlWord = 0x06;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->ControlWord = 0x06;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                    drivers[i].rx->ControlWord = 0x06;
-                    imp.ecats[drivers[i].order].rxPDOSwaps[drivers[i].domain]->advanceNodePtr();
-                }
-                break;
-            case 0:
-                drivers[i].rx->ControlWord = 0x06;
-                break;
-            case -1:
-                drivers[i].rx->ControlWord = 0x86;
-                imp.putDriverSDORequest(drivers[i].parameters.clearErrorSDO);
-                if (imp.getDriverSDOResponse(drivers[i].parameters.clearErrorSDO) == 0)
-                {
-                    if (drivers[i].parameters.clearErrorSDO.state < 0)
-                    {
-                        printf("requesting drivers[%d] clearError failed\n", i);
-                    }
-                }
-                break;
-            }
+            drivers[i].desired = enabled[i];
             i++;
         }
-        imp.ecatUpdate();
-        return 0;
+        return imp.motorTarget(pos, vel, tor);
     }
     
     // 获取电机实际值
     int DriverSDK::getMotorActual(std::vector<motorActualStruct> &data)
     {
-        if (data.size() != dofAll || ecatStalled.load())
+        if (data.size() != dofAll)
         {
             return -1;
         }
-        int i = 0;
-        while (i < dofAll)
+        return getMotorActual(data.data(), dofAll);
+    }
+
+    // 获取电机实际值，data指向count个连续的motorActualStruct，count须等于getTotalMotorNr()
+    int DriverSDK::getMotorActual(motorActualStruct *data, int const count)
+    {
+        if (count != dofAll)
         {
-            if (drivers[i].order < 0)
-            {
-                data[i].statusWord = 0xffff;
-                i++;
-                continue;
-            }
-            imp.putDriverSDORequest(drivers[i].parameters.temperatureSDO);
-            data[i].pos = 2.0 * Pi * drivers[i].parameters.polarity * (drivers[i].tx->ActualPosition - drivers[i].parameters.countBias) / drivers[i].parameters.encoderResolution / drivers[i].parameters.gearRatioPosVel;
-            data[i].vel = 2.0 * Pi * drivers[i].parameters.polarity * drivers[i].tx->ActualVelocity / drivers[i].parameters.encoderResolution / drivers[i].parameters.gearRatioPosVel;
-            data[i].tor = drivers[i].parameters.polarity * drivers[i].tx->ActualTorque / 1000.0 * drivers[i].parameters.ratedCurrent * drivers[i].parameters.torqueConstant * drivers[i].parameters.gearRatioTor;
-            if (imp.getDriverSDOResponse(drivers[i].parameters.temperatureSDO) == 0)
-            {
-                if (drivers[i].parameters.temperatureSDO.state < 0)
-                {
-                    printf("requesting drivers[%d] temperature failed\n", i);
-                }
-                else
-                {
-                    data[i].temp = drivers[i].parameters.temperatureSDO.value;
-                }
-            }
-            data[i].statusWord = drivers[i].tx->StatusWord;
-            data[i].errorCode = drivers[i].tx->ErrorCode;
-            i++;
+            return -1;
         }
-        imp.sdoRequestableUpdate();
-        return 0;
+        return imp.motorActual(data, nullptr);
+    }
+
+    // 获取电机实际值（结构数组），各数组须含getTotalMotorNr()个元素，不做长度检查；temp、statusWord、errorCode可为空
+    int DriverSDK::getMotorActual(float *pos, float *vel, float *tor, short *temp, unsigned short *statusWord, unsigned short *errorCode)
+    {
+        return imp.motorActual(pos, vel, tor, temp != nullptr ? temp : imp.temperatures.data(), statusWord != nullptr ? statusWord : imp.statusWords.data(), errorCode != nullptr ? errorCode : imp.errorCodes.data());
+    }
+
+    // 获取电机实际值及其所属帧的元数据，二者取自同一次提交的快照
+    int DriverSDK::getMotorActual(std::vector<motorActualStruct> &data, std::vector<frameStruct> &frames)
+    {
+        if (data.size() != dofAll || frames.size() != dofAll)
+        {
+            return -1;
+        }
+        return imp.motorActual(data.data(), frames.data());
     }
 
     // 发送电机SDO请求
@@ -1068,9 +1325,23 @@ namespace DriverSDK
         drivers[data.i].parameters.sdoTemplate.signed_ = data.signed_;
         drivers[data.i].parameters.sdoTemplate.bitLength = data.bitLength;
         drivers[data.i].parameters.sdoTemplate.operation = data.operation;
+        drivers[data.i].parameters.sdoTemplate.value = data.value;
         return imp.putDriverSDORequest(drivers[data.i].parameters.sdoTemplate);
     }
 
+    // 按句柄发送电机SDO请求，写操作时value为写入值；返回值与sendMotorSDORequest相同
+    int DriverSDK::sendMotorSDORequest(int const i, int const handle, long const value)
+    {
+        motorSDOClass data(i);
+        int ret = fillSDO(data, handle);
+        if (ret != 0)
+        {
+            return ret;
+        }
+        data.value = value;
+        return sendMotorSDORequest(data);
+    }
+
     // 接收电机SDO响应
     int DriverSDK::recvMotorSDOResponse(motorSDOClass &data)
     {
@@ -1078,9 +1349,11 @@ namespace DriverSDK
         {
             return 1;
         }
-        drivers[data.i].parameters.sdoTemplate.index = data.index;
-        drivers[data.i].parameters.sdoTemplate.subindex = data.subindex;
-        drivers[data.i].parameters.sdoTemplate.operation = data.operation;
+        SDOMsg const &pending = drivers[data.i].parameters.sdoTemplate;
+        if (pending.index != data.index || pending.subindex != data.subindex || pending.operation != data.operation)
+        {
+            return -1;
+        }
         int ret = imp.getDriverSDOResponse(drivers[data.i].parameters.sdoTemplate);
         if (ret == 0)
         {
@@ -1097,41 +1370,291 @@ namespace DriverSDK
         return ret;
     }
 
-    // 校准
-    int DriverSDK::calibrate(int const i)
+    // 异步发送电机SDO请求，请求结束（完成、失败或超过截止时间）时在SDO线程中调用callback
+    int DriverSDK::sendMotorSDOAsync(motorSDOClass const &data, std::function<void(motorSDOClass const &)> const &callback, int const priority, int const timeout)
     {
-        if (drivers[i].order != 0)
+        if (data.i < 0 || data.i >= dofAll || drivers[data.i].sdoHandler == nullptr || data.index == 0x0000)
         {
-            return std::numeric_limits<int>::max();
+            return -1;
         }
-        motorSDOClass data(i);
-        if (fillSDO(data, "ActualPosition") != 0)
+        SDOMsg msg = drivers[data.i].parameters.sdoTemplate;
+        msg.value = data.value;
+        msg.index = data.index;
+        msg.subindex = data.subindex;
+        msg.signed_ = data.signed_;
+        msg.bitLength = data.bitLength;
+        msg.operation = data.operation;
+        std::function<void(SDOMsg const &)> *completion = new std::function<void(SDOMsg const &)>([data, callback](SDOMsg const &sdoMsg) {
+            motorSDOClass result = data;
+            result.state = sdoMsg.state;
+            if (sdoMsg.state >= 0)
+            {
+                result.value = sdoMsg.value;
+            }
+            callback(result);
+        });
+        if (imp.submitDriverSDORequest(msg, priority, timeout, completion) != 0)
         {
-            return std::numeric_limits<int>::min();
+            delete completion;
+            return -1;
         }
-        long period = configXML->period("ECAT", drivers[i].order);
-        int tryCount = 0;
-        while (sendMotorSDORequest(data) != 0)
+        return 0;
+    }
+
+    // 异步发送电机SDO请求，返回在请求结束时就绪的future
+    std::future<motorSDOClass> DriverSDK::sendMotorSDOAsync(motorSDOClass const &data, int const priority, int const timeout)
+    {
+        std::shared_ptr<std::promise<motorSDOClass>> promise = std::make_shared<std::promise<motorSDOClass>>();
+        std::future<motorSDOClass> future = promise->get_future();
+        if (sendMotorSDOAsync(data, [promise](motorSDOClass const &result) { promise->set_value(result); }, priority, timeout) != 0)
+        {
+            motorSDOClass result = data;
+            result.state = -1;
+            promise->set_value(result);
+        }
+        return future;
+    }
+
+    // 批量SDO传输：全部请求提交到各自主站的SDO线程，不同从站并行、同一从站连续执行，池中消息用尽时等待已提交的请求结束后续交；
+    // 全部请求在timeout（毫秒）内结束，结果写回data，state为3表示成功、-1表示失败；index为0的请求（不在ECAT总线上）保持原样
+    int DriverSDK::transferMotorSDO(std::vector<motorSDOClass> &data, int const timeout)
+    {
+        struct Batch
+        {
+            std::mutex mutex;
+            std::condition_variable done;
+            std::vector<motorSDOClass> results;
+            int outstanding;
+        };
+        std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+        batch->results = data;
+        batch->outstanding = 0;
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        int i = 0;
+        while (i < data.size())
+        {
+            if (data[i].index == 0x0000)
+            {
+                i++;
+                continue;
+            }
+            int remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            int k = i;
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->outstanding++;
+            lock.unlock();
+            if (remaining > 0 && sendMotorSDOAsync(data[i], [batch, k](motorSDOClass const &result) {
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    batch->results[k] = result;
+                    batch->outstanding--;
+                    batch->done.notify_all();
+                }, SDO_PRI_LOW, remaining) == 0)
+            {
+                i++;
+                continue;
+            }
+            lock.lock();
+            batch->outstanding--;
+            if (remaining <= 0 || batch->outstanding == 0)
+            {
+                batch->results[i].state = -1;
+                i++;
+                continue;
+            }
+            int outstanding = batch->outstanding;
+            batch->done.wait(lock, [&batch, outstanding] { return batch->outstanding < outstanding; });
+        }
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->done.wait(lock, [&batch] { return batch->outstanding == 0; });
+        int failed = 0;
+        i = 0;
+        while (i < data.size())
+        {
+            data[i] = batch->results[i];
+            if (data[i].state < 0)
+            {
+                failed++;
+            }
+            i++;
+        }
+        return failed;
+    }
+
+    // 按对象名批量读取：对象名经配置文件解析为索引、子索引与位长度，全部以读操作通过transferMotorSDO执行
+    int DriverSDK::readMotorObjects(std::vector<int> const &joints, std::vector<std::string> const &objects, std::vector<motorSDOClass> &data, int const timeout)
+    {
+        data.clear();
+        int i = 0;
+        while (i < joints.size())
+        {
+            int j = 0;
+            while (j < objects.size())
+            {
+                motorSDOClass sdo(joints[i]);
+                if (fillSDO(sdo, objects[j].c_str()) < 0)
+                {
+                    return -1;
+                }
+                sdo.operation = 1;
+                data.push_back(sdo);
+                j++;
+            }
+            i++;
+        }
+        return transferMotorSDO(data, timeout);
+    }
+
+    // 把一组SDO统计累加到输出结构体
+    void DriverSDK::impClass::sdoStatsAdd(sdoStatsStruct &data, SDOStats const &stats)
+    {
+        static_assert(HIST_BUCKETS == HISTOGRAM_BUCKETS, "HIST_BUCKETS must match HISTOGRAM_BUCKETS");
+        unsigned long buckets[HISTOGRAM_BUCKETS], count = 0, min = 0, max = 0;
+        stats.latency.read(buckets, count, min, max);
+        data.count += count;
+        if (max > data.maxLatency)
+        {
+            data.maxLatency = max;
+        }
+        int i = 0;
+        while (i < HISTOGRAM_BUCKETS)
+        {
+            data.latency[i] += buckets[i];
+            i++;
+        }
+        stats.retries.read(buckets, count, min, max);
+        i = 0;
+        while (i < HISTOGRAM_BUCKETS)
+        {
+            data.retries[i] += buckets[i];
+            i++;
+        }
+        data.failures += stats.failures.load(std::memory_order_relaxed);
+    }
+
+    // 获取SDO统计
+    int DriverSDK::getSDOStats(std::vector<sdoStatsStruct> &slaves, std::vector<sdoStatsStruct> &objects)
+    {
+        slaves.clear();
+        objects.clear();
+        int i = 0;
+        while (i < dofAll)
         {
-            tryCount++;
-            if (tryCount > 2 * dofAll * dofAll)
+            if (imp.sdoTypes[i] >= 0)
             {
-                return std::numeric_limits<int>::min();
+                sdoStatsStruct data;
+                memset(&data, 0, sizeof(sdoStatsStruct));
+                data.i = i;
+                imp.sdoStatsAdd(data, imp.ecats[drivers[i].order].sdoSlaveStats[i]);
+                slaves.push_back(data);
             }
-            recvMotorSDOResponse(data);
-            usleep(period / 1000);
-            imp.sdoRequestableUpdate();
+            i++;
         }
-        tryCount = 0;
-        while (recvMotorSDOResponse(data) != 0)
+        i = 0;
+        while (i < imp.ecats.size())
         {
-            tryCount++;
-            if (tryCount > 2 * dofAll * dofAll)
+            int j = 0;
+            while (j < SDO_STAT_OBJECTS)
             {
-                return std::numeric_limits<int>::min();
+                SDOStats const &stats = imp.ecats[i].sdoObjectStats[j];
+                int key = stats.key.load(std::memory_order_acquire);
+                if (key < 0)
+                {
+                    break;
+                }
+                int k = 0;
+                while (k < objects.size() && (objects[k].index != (key >> 8) || objects[k].subindex != (key & 0xff)))
+                {
+                    k++;
+                }
+                if (k == objects.size())
+                {
+                    sdoStatsStruct data;
+                    memset(&data, 0, sizeof(sdoStatsStruct));
+                    data.i = -1;
+                    data.index = key >> 8;
+                    data.subindex = key & 0xff;
+                    objects.push_back(data);
+                }
+                imp.sdoStatsAdd(objects[k], stats);
+                j++;
             }
-            usleep(period / 1000);
+            i++;
+        }
+        return 0;
+    }
+
+    // 读取一个周期直方图并计算分位数
+    void DriverSDK::impClass::cycleHistFill(cycleHistStruct &data, Histogram const &histogram)
+    {
+        histogram.read(data.buckets, data.count, data.min, data.max);
+        data.p99 = Histogram::quantile(data.buckets, data.count, data.max, 0.99);
+        data.p999 = Histogram::quantile(data.buckets, data.count, data.max, 0.999);
+    }
+
+    // 获取各ECAT主站的总线周期统计，每个主站的四个直方图与超时计数取自同一周期结束时刻
+    int DriverSDK::getCycleStats(std::vector<cycleStatsStruct> &data)
+    {
+        data.clear();
+        int i = 0;
+        while (i < imp.ecats.size())
+        {
+            if (imp.ecats[i].alias2type.size() == 0)
+            {
+                i++;
+                continue;
+            }
+            CycleStats const *stats = imp.ecats[i].cycleStats;
+            cycleStatsStruct snapshot;
+            unsigned int sequence = 0;
+            do
+            {
+                sequence = stats->sequence.load(std::memory_order_acquire);
+                if (sequence % 2 != 0)
+                {
+                    continue;
+                }
+                snapshot.master = i;
+                snapshot.overruns = stats->overruns.load(std::memory_order_relaxed);
+                snapshot.missed = stats->missed.load(std::memory_order_relaxed);
+                snapshot.streak = stats->streak.load(std::memory_order_relaxed);
+                imp.cycleHistFill(snapshot.lateness, stats->lateness);
+                imp.cycleHistFill(snapshot.send, stats->send);
+                imp.cycleHistFill(snapshot.process, stats->process);
+                imp.cycleHistFill(snapshot.loop, stats->loop);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while (sequence % 2 != 0 || stats->sequence.load(std::memory_order_relaxed) != sequence);
+            data.push_back(snapshot);
+            i++;
+        }
+        return 0;
+    }
+
+    // 获取被推迟的SDO发起次数
+    unsigned long DriverSDK::getSDODeferred()
+    {
+        unsigned long ret = 0;
+        int i = 0;
+        while (i < imp.ecats.size())
+        {
+            ret += imp.ecats[i].sdoTable->deferred.load(std::memory_order_relaxed);
+            i++;
+        }
+        return ret;
+    }
+
+    // 校准
+    int DriverSDK::calibrate(int const i)
+    {
+        if (drivers[i].order != 0)
+        {
+            return std::numeric_limits<int>::max();
+        }
+        motorSDOClass data(i);
+        if (fillSDO(data, "ActualPosition") != 0)
+        {
+            return std::numeric_limits<int>::min();
         }
+        data = sendMotorSDOAsync(data, SDO_PRI_HIGH).get();
         if (data.state < 0)
         {
             return std::numeric_limits<int>::min();
@@ -1146,6 +1669,7 @@ namespace DriverSDK
         }
         configXML->save();
         drivers[i].parameters.countBias = data.value;
+        conversion.update(i, drivers[i].parameters);
         return data.value;
     }
 
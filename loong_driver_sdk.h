@@ -20,6 +20,12 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <functional>
+#include <future>
+
+#define SDO_PRI_LOW 0  // SDO普通优先级, 如遥测、参数读取
+#define SDO_PRI_HIGH 1 // SDO高优先级, 如故障复位, 先于普通优先级的请求派发
+#define HIST_BUCKETS 24 // 直方图桶数量: 第0桶为0, 第k桶为[2^(k-1), 2^k), 最后一桶包含以上全部
 
 namespace DriverSDK     
 {
@@ -54,7 +60,7 @@ namespace DriverSDK
         float pos;   // 位置
         float vel;   // 速度
         float tor;   // 力矩
-        int enabled; // -1: 清除错误, 0: 禁用, 1: 启用
+        int enabled; // 期望状态, 由总线周期线程执行CiA 402状态机: -1: 清除错误, 0: 禁用, 1: 启用, 2: 快速停止
     };
 
     struct motorActualStruct // 电机实际结构体
@@ -67,6 +73,49 @@ namespace DriverSDK
         unsigned short errorCode;  // 错误码
     };
 
+    struct frameStruct // 帧元数据结构体
+    {
+        unsigned long cycle;    // 数据所属的总线周期计数
+        long long rxTime;       // 接收时间: CLOCK_MONOTONIC, 纳秒
+        long long dcTime;       // 该周期的DC应用时间, 纳秒; 未启用DC时为0
+        int workingCounter;     // 工作计数器
+        int wcState;            // 工作计数器状态: 0: 无应答; 1: 不完整; 2: 完整; -1: 电机不在总线上; 非2时未应答从站的数据为旧值
+    };
+
+    struct sdoStatsStruct // SDO统计结构体
+    {
+        int i;                                 // 驱动器索引[i]; 按对象统计时为-1
+        unsigned short index;                  // 索引; 按驱动器统计时为0
+        unsigned char subindex;                // 子索引; 按驱动器统计时为0
+        unsigned long count;                   // 已结束的请求数, 含温度轮询
+        unsigned long failures;                // 以错误结束的请求数
+        unsigned long maxLatency;              // 最大延迟, 微秒
+        unsigned long latency[HIST_BUCKETS];   // 提交到结束的延迟直方图, 微秒
+        unsigned long retries[HIST_BUCKETS];   // 从站返回错误后的重试次数直方图
+    };
+
+    struct cycleHistStruct // 周期直方图结构体, 单位纳秒
+    {
+        unsigned long count;                 // 样本数
+        unsigned long min;                   // 最小值
+        unsigned long max;                   // 最大值
+        unsigned long p99;                   // 99%分位, 取所在桶的上界
+        unsigned long p999;                  // 99.9%分位, 取所在桶的上界
+        unsigned long buckets[HIST_BUCKETS]; // 各桶样本数
+    };
+
+    struct cycleStatsStruct // 总线周期统计结构体
+    {
+        int master;               // ECAT主站序号
+        unsigned long overruns;   // 发送完成时已超过下一周期起点的周期数
+        unsigned long missed;     // 超时后按主站overrun策略跳过或重新计时所放弃的周期数
+        unsigned long streak;     // 最长的连续超时周期数
+        cycleHistStruct lateness; // 唤醒时刻相对周期起点的延迟
+        cycleHistStruct send;     // 唤醒到同一周期ecrt_master_send返回
+        cycleHistStruct process;  // ecrt_master_receive返回到处理完全部域
+        cycleHistStruct loop;     // 唤醒到同一周期处理完全部域
+    };
+
     class motorSDOClass // 电机SDO类
     {
     public:
@@ -82,11 +131,15 @@ namespace DriverSDK
         ~motorSDOClass();        // 析构函数
     };
 
+    // get*类读取接口可由多个线程并发调用，内部以同一把锁串行取数据；每次调用返回的数据及帧元数据取自同一次提交
     class DriverSDK
     {
     public:
         static DriverSDK &instance();
         void setCPU(unsigned short const cpu);
+        void setTempPeriod(unsigned int const period);
+        int setOverrunCallback(std::function<void(int const, unsigned int const)> const &callback);  // 须在init()前调用, 之后调用返回-1; 某ECAT主站连续超时周期数超过其overrun_limit时以(主站序号, 连续超时数)调用一次, 在该主站的SDO线程中执行, 执行期间该主站的SDO请求暂停推进
+        void setSDOSlack(unsigned int const percent);                          // 实时线程周期余量低于周期的percent%时推迟发起SDO读写, 默认20, 0为不限制
         void setMaxCurr(std::vector<unsigned short> const &maxCurr);
         int setMode(std::vector<char> const &mode);
         void init(char const *xmlFile);
@@ -96,14 +149,29 @@ namespace DriverSDK
         std::vector<int> getActiveMotors();
         int setCntBias(std::vector<int> const &cntBias);
         int fillSDO(motorSDOClass &data, char const *object);
+        int getSDOHandle(int const i, char const *object);                    // 对象名解析一次, 返回句柄, 同类型驱动器共用; 失败返回-1
+        int fillSDO(motorSDOClass &data, int const handle);                   // 按句柄填充, 无XML与字符串开销
         void getIMU(imuStruct &data);
         int getSensor(std::vector<sensorStruct> &data);
         int setDigitTarget(std::vector<digitTargetStruct> const &data);
         int getDigitActual(std::vector<digitActualStruct> &data);
         int setMotorTarget(std::vector<motorTargetStruct> const &data);
+        int setMotorTarget(motorTargetStruct const *data, int const count);                          // count须等于getTotalMotorNr()
+        int setMotorTarget(float const *pos, float const *vel, float const *tor, int const *enabled); // 结构数组, 各含getTotalMotorNr()个元素
         int getMotorActual(std::vector<motorActualStruct> &data);
+        int getMotorActual(std::vector<motorActualStruct> &data, std::vector<frameStruct> &frames);
+        int getMotorActual(motorActualStruct *data, int const count);                                // count须等于getTotalMotorNr()
+        int getMotorActual(float *pos, float *vel, float *tor, short *temp = nullptr, unsigned short *statusWord = nullptr, unsigned short *errorCode = nullptr); // 结构数组, 各含getTotalMotorNr()个元素
         int sendMotorSDORequest(motorSDOClass const &data);
+        int sendMotorSDORequest(int const i, int const handle, long const value = 0); // 按句柄发送, 写操作时value为写入值
         int recvMotorSDOResponse(motorSDOClass &data);
+        int sendMotorSDOAsync(motorSDOClass const &data, std::function<void(motorSDOClass const &)> const &callback, int const priority = SDO_PRI_LOW, int const timeout = 500); // 回调在SDO线程中执行, 须尽快返回; timeout: 毫秒; 提交失败返回-1且不调用回调
+        std::future<motorSDOClass> sendMotorSDOAsync(motorSDOClass const &data, int const priority = SDO_PRI_LOW, int const timeout = 500); // 提交失败时future立即就绪, state为-1
+        int transferMotorSDO(std::vector<motorSDOClass> &data, int const timeout = 5000); // 批量读写, 结果写回data; timeout: 毫秒; 返回失败的请求数
+        int readMotorObjects(std::vector<int> const &joints, std::vector<std::string> const &objects, std::vector<motorSDOClass> &data, int const timeout = 5000); // 按对象名批量读取, data按joints×objects逐行排列; 返回失败的请求数
+        unsigned long getSDODeferred();                                       // 因周期余量不足被推迟的SDO发起次数, 各主站累计
+        int getCycleStats(std::vector<cycleStatsStruct> &data);               // 各ECAT主站的总线周期统计, 每个主站为同一时刻的快照
+        int getSDOStats(std::vector<sdoStatsStruct> &slaves, std::vector<sdoStatsStruct> &objects); // 按驱动器与按对象的SDO统计, 同一对象在各主站的统计合并
         int calibrate(int const i);
         void advance();
         std::string version();
@@ -0,0 +1,206 @@
+/* Copyright 2025 人形机器人（上海）有限公司
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Designed and built with love @zhihu by @cjrcl.
+ */
+
+#pragma once
+
+#include "arena.h"
+#include <stddef.h>
+#include <new>
+#include <atomic>
+
+#define MAX_RING_SIZE 1024
+
+// 有界无锁指针队列：每个槽位带序号，生产者与消费者各自用CAS推进位置，可多写多读；
+// 不使用互斥锁、信号量，也不做堆分配，满时put()返回-1，空时get_nonblocking()返回nullptr
+template <typename T, int const N = MAX_RING_SIZE>
+class PtrRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "PtrRing size must be a power of 2");
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T *msg;
+    };
+    Cell cells[N];
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> putIndex;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> getIndex;
+
+public:
+    static void *operator new(size_t const size)
+    {
+        return DriverSDK::Arena::instance().allocate(size);
+    }
+    static void operator delete(void *ptr)
+    {
+        DriverSDK::Arena::instance().release(ptr);
+    }
+    PtrRing()
+    {
+        int i = 0;
+        while (i < N)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+            cells[i].msg = nullptr;
+            i++;
+        }
+        putIndex.store(0, std::memory_order_relaxed);
+        getIndex.store(0, std::memory_order_relaxed);
+    }
+    int put(T *msg)
+    {
+        size_t position = putIndex.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell *cell = &cells[position & (N - 1)];
+            long difference = (long)cell->sequence.load(std::memory_order_acquire) - (long)position;
+            if (difference == 0)
+            {
+                if (putIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell->msg = msg;
+                    cell->sequence.store(position + 1, std::memory_order_release);
+                    return 0;
+                }
+            }
+            else if (difference < 0)
+            {
+                return -1;
+            }
+            else
+            {
+                position = putIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    T *get_nonblocking()
+    {
+        size_t position = getIndex.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell *cell = &cells[position & (N - 1)];
+            long difference = (long)cell->sequence.load(std::memory_order_acquire) - (long)(position + 1);
+            if (difference == 0)
+            {
+                if (getIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    T *msg = cell->msg;
+                    cell->sequence.store(position + N, std::memory_order_release);
+                    return msg;
+                }
+            }
+            else if (difference < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                position = getIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    size_t size()
+    {
+        size_t got = getIndex.load(std::memory_order_relaxed);
+        size_t put = putIndex.load(std::memory_order_relaxed);
+        return put > got ? put - got : 0;
+    }
+    size_t maxSize()
+    {
+        return N;
+    }
+};
+
+// 定长对象池：init()时从SDK内存区一次性分配count个对象，之后借出与归还只经过无锁队列，用尽时get()返回nullptr
+template <typename T, int const N = MAX_RING_SIZE>
+class PtrPool
+{
+private:
+    T *items;
+    int count;
+    PtrRing<T, N> ring;
+
+public:
+    static void *operator new(size_t const size)
+    {
+        return DriverSDK::Arena::instance().allocate(size);
+    }
+    static void operator delete(void *ptr)
+    {
+        DriverSDK::Arena::instance().release(ptr);
+    }
+    PtrPool()
+    {
+        items = nullptr;
+        count = 0;
+    }
+    int init(int const count)
+    {
+        if (items != nullptr || count <= 0 || count > N)
+        {
+            return -1;
+        }
+        items = (T *)DriverSDK::Arena::instance().allocate(count * sizeof(T));
+        if (items == nullptr)
+        {
+            return -1;
+        }
+        this->count = count;
+        int i = 0;
+        while (i < count)
+        {
+            new (items + i) T();
+            ring.put(items + i);
+            i++;
+        }
+        return 0;
+    }
+    T *get()
+    {
+        return ring.get_nonblocking();
+    }
+    void put(T *item)
+    {
+        if (owns(item))
+        {
+            ring.put(item);
+        }
+    }
+    bool owns(T const *item)
+    {
+        return item >= items && item < items + count;
+    }
+    size_t available()
+    {
+        return ring.size();
+    }
+    ~PtrPool()
+    {
+        if (items == nullptr)
+        {
+            return;
+        }
+        int i = 0;
+        while (i < count)
+        {
+            items[i].~T();
+            i++;
+        }
+        DriverSDK::Arena::instance().release(items);
+    }
+};
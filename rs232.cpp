@@ -32,9 +32,8 @@ RS232::RS232(char const* device, int const baudrate, int const frameLength, unsi
     txSwap = new SwapList(frameLength);
     int i = 0;
     while(i < 3){
-        txSwap->nodePtr.load()->memPtr[0] = header0;
-        txSwap->nodePtr.load()->memPtr[1] = header1;
-        txSwap->advanceNodePtr();
+        txSwap->nodes[i]->memPtr[0] = header0;
+        txSwap->nodes[i]->memPtr[1] = header1;
         i++;
     }
     pth = 0;
@@ -52,6 +51,7 @@ void RS232::cleanup(void* arg){
 
 void* RS232::recv(void* arg){
     RS232* obj = (RS232*)arg;
+    stackPrefault();
     int    speedArray[] = {B921600, B576000, B460800, B230400, B115200, B57600, B38400, B19200, B9600, B4800, B2400, B1200, B300};
     int baudrateArray[] = { 921600,  576000,  460800,  230400,  115200,  57600,  38400,  19200,  9600,  4800,  2400,  1200,  300};
     int i = 0, j;
@@ -126,14 +126,14 @@ void* RS232::recv(void* arg){
         }
         node = node->next;
         if(i < obj->frameLength){
-            obj->txSwap->nodePtr.load()->next->memPtr[i] = buff[node->nr];
+            obj->txSwap->writer()[i] = buff[node->nr];
             i++;
         }
         if(buff[node->previous->nr] == obj->header0 && buff[node->nr] == obj->header1){
-            if(obj->valid(obj->txSwap->nodePtr.load()->next->memPtr)){
-                obj->txSwap->advanceNodePtr();
+            if(obj->valid(obj->txSwap->writer())){
+                obj->txSwap->commit(false);
             }
-            memset(obj->txSwap->nodePtr.load()->next->memPtr + 2, 0, obj->frameLength - 2);
+            memset(obj->txSwap->writer() + 2, 0, obj->frameLength - 2);
             i = 2;
             nanosleep(&step, nullptr);
         }
@@ -142,11 +142,11 @@ void* RS232::recv(void* arg){
     return nullptr;
 }
 
-int RS232::run(){
+int RS232::run(char const* name){
     if(strlen(device) == 0){
         return 1;
     }
-    if(pthread_create(&pth, nullptr, &recv, this) != 0){
+    if(threadCreate(&pth, name, &recv, this, nullptr) != 0){
         printf("creating serialRead thread failed\n");
         return -1;
     }
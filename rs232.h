@@ -37,7 +37,7 @@ public:
     virtual bool valid(unsigned char const* buff) = 0;
     static void cleanup(void* arg);
     static void* recv(void* arg);
-    int run();
+    int run(char const* name);
     ~RS232();
 };
 
@@ -39,14 +39,14 @@ void changingTekRX(modbus_t* const ctx, int const alias){
         if(count % 8 != 0){
             return;
         }
-        position = digits[0].rx->TargetPosition;
+        position = digits[0].rx.bus()->TargetPosition;
     }else if(alias == 201){
         static unsigned int count = 0xffffffff;
         count++;
         if(count % 8 != 0){
             return;
         }
-        position = digits[dofLeftEffector].rx->TargetPosition;
+        position = digits[dofLeftEffector].rx.bus()->TargetPosition;
     }
     position *= 100;
     data[0] = position >> 16 & 0xffff;
@@ -76,9 +76,9 @@ void changingTekTX(modbus_t* const ctx, int const alias){
     *(unsigned short*)&position = data[1];
     position = (position - 100) * 90 / (1150 - 100);
     if(alias == 200){
-        digits[0].tx->ActualPosition = position;
+        digits[0].tx.bus()->ActualPosition = position;
     }else if(alias == 201){
-        digits[dofLeftEffector].tx->ActualPosition = position;
+        digits[dofLeftEffector].tx.bus()->ActualPosition = position;
     }
 }
 
@@ -93,7 +93,7 @@ void InspireRX(modbus_t* const ctx, int const alias){
         i = dofLeftEffector;
     }
     while(j < 6){
-        targetPositions[j] = 1000 - digits[i + j].rx->TargetPosition * 1000 / 90;
+        targetPositions[j] = 1000 - digits[i + j].rx.bus()->TargetPosition * 1000 / 90;
         j++;
     }
     modbus_set_slave(ctx, alias);
@@ -125,7 +125,7 @@ void InspireTX(modbus_t* const ctx, int const alias){
     j = 0;
     while(j < 6){
         if(readResults[j] == 1){
-            digits[i + j].tx->ActualPosition = 90 - actualPositions[j] * 90 / 1000;
+            digits[i + j].tx.bus()->ActualPosition = 90 - actualPositions[j] * 90 / 1000;
         }
         j++;
     }
@@ -292,6 +292,7 @@ int RS485::config(){
 
 void* RS485::rxtx(void* arg){
     RS485* rs485 = (RS485*)arg;
+    stackPrefault();
     if(rs485->baudrate == std::numeric_limits<int>::max()){
         printf("rs485s[%d], deviceR %s, deviceS %s, period %ld\n", rs485->order, rs485->deviceR, rs485->deviceS, rs485->period);
     }else{
@@ -304,6 +305,7 @@ void* RS485::rxtx(void* arg){
     }
     clock_gettime(CLOCK_MONOTONIC, &wakeupTime);
     while(true){
+        rs485->rxSwap->fetch();
         if(rs485->leftRX != nullptr){
             rs485->leftRX(rs485->ctx, 200);
             nanosleep(&step, nullptr);
@@ -335,7 +337,7 @@ void* RS485::rxtx(void* arg){
             rs485->rightTX(rs485->ctx, 201);
             nanosleep(&step, nullptr);
         }
-        rs485->txSwap->advanceNodePtr();
+        rs485->txSwap->commit();
     }
     return nullptr;
 }
@@ -344,7 +346,8 @@ int RS485::run(){
     if(alias2type.size() == 0){
         return 0;
     }
-    if(pthread_create(&pth, nullptr, &rxtx, this) != 0){
+    std::string name = "rs485." + std::to_string(order);
+    if(threadCreate(&pth, name.c_str(), &rxtx, this, nullptr) != 0){
         printf("creating rs485s[%d] rxtx thread failed\n", order);
         return -1;
     }